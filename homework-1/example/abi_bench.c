@@ -0,0 +1,72 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "counter.hpp"
+#include "scheduler.hpp"
+
+// Стоимость вызова через C ABI: сколько вызовов в секунду выдерживает
+// counter_increment, такт планировщика (scheduler_update + scheduler_pop_ready)
+// и тривиальные геттеры. Геттеры меряются дважды: вызовом функции из библиотеки
+// ((counter_get)(c) — скобки отключают макрос) и так, как их видит обычный код:
+// со сборкой EXAMPLE_INLINE_GETTERS это чтение поля без вызова.
+//
+// ./abi_bench [calls] [tasks]
+
+static double seconds_since(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void report(const char* what, unsigned long long calls, double seconds) {
+    printf("%-20s %12llu calls  %8.3f s  %8.2f Mcalls/s  %6.2f ns/call\n", what, calls, seconds,
+           seconds > 0 ? (double)calls / seconds / 1e6 : 0.0, seconds > 0 ? seconds * 1e9 / (double)calls : 0.0);
+}
+
+int main(int argc, char** argv) {
+    unsigned long long calls = argc > 1 ? strtoull(argv[1], NULL, 10) : 100000000ull;
+    unsigned tasks = argc > 2 ? (unsigned)strtoul(argv[2], NULL, 10) : 100;
+
+    Counter* c = counter_create(0);
+    // volatile-указатель не даёт компилятору (с LTO) схлопнуть цикл или вынести чтение из него.
+    Counter* volatile cv = c;
+    clock_t start = clock();
+    for (unsigned long long i = 0; i < calls; i++) counter_increment(cv);
+    report("counter_increment", calls, seconds_since(start));
+    printf("%-20s %12d value\n", "", counter_get(c));
+
+    long long sum = 0;
+    start = clock();
+    for (unsigned long long i = 0; i < calls; i++) sum += (counter_get)(cv);
+    report("counter_get (call)", calls, seconds_since(start));
+    start = clock();
+    for (unsigned long long i = 0; i < calls; i++) sum += counter_get(cv);
+    report("counter_get", calls, seconds_since(start));
+    counter_destroy(c);
+
+    // Такт планировщика: время идёт по 1 мс, задачи с периодом 1000 мс разнесены по фазе,
+    // так что на большинстве тактов готовых задач нет и меряется в основном сам вызов.
+    Scheduler* s = scheduler_create();
+    if (!s) return 1;
+    for (unsigned i = 0; i < tasks; i++) scheduler_add_task(s, "poll", 1000, i % 1000);
+    unsigned long long ticks = calls / 10;
+    unsigned long long fired = 0;
+    uint32_t ready[64];
+    start = clock();
+    for (unsigned long long now = 0; now < ticks; now++) {
+        scheduler_update(s, now);
+        fired += scheduler_pop_ready(s, ready, sizeof(ready) / sizeof(ready[0]));
+    }
+    report("scheduler tick", ticks, seconds_since(start));
+    printf("%-20s %12llu fired\n", "", fired);
+
+    Scheduler* volatile sv = s;
+    size_t count = 0;
+    start = clock();
+    for (unsigned long long i = 0; i < calls; i++) count += (scheduler_task_count)(sv);
+    report("task_count (call)", calls, seconds_since(start));
+    start = clock();
+    for (unsigned long long i = 0; i < calls; i++) count += scheduler_task_count(sv);
+    report("task_count", calls, seconds_since(start));
+    printf("%-20s %12lld checksum\n", "", sum + (long long)count);
+    scheduler_destroy(s);
+    return 0;
+}
@@ -1,45 +1,47 @@
 #include "counter.hpp"
 
+#include <type_traits>
+
 class CounterImpl {
 public:
-    explicit CounterImpl(int value) : value_(value) {}
+    explicit CounterImpl(int value) : state_{value} {}
 
-    void increment() { ++value_; }
-    void decrement() { --value_; }
-    int get() const { return value_; }
+    void increment() { ++state_.value; }
+    void decrement() { --state_.value; }
+    int get() const { return state_.value; }
 
 private:
-    int value_;
+    CounterState state_;    // первым полем: его читает counter_get_inline
 };
 
+// Реализация лежит прямо в непрозрачной структуре: одно выделение памяти
+// и одно разыменование на вызов вместо двух.
 struct Counter {
-    CounterImpl* impl;
+    CounterImpl impl;
 };
 
+static_assert(std::is_standard_layout<Counter>::value, "CounterState must start Counter");
+
 extern "C" {
 
 Counter* counter_create(int initial_value) {
-    Counter* counter = new Counter;
-    counter->impl = new CounterImpl(initial_value);
-    return counter;
+    return new Counter{CounterImpl(initial_value)};
 }
 
 void counter_destroy(Counter* counter) {
-    if (!counter) return;
-    delete counter->impl;
     delete counter;
 }
 
 void counter_increment(Counter* counter) {
-    if (counter) counter->impl->increment();
+    if (counter) counter->impl.increment();
 }
 
 void counter_decrement(Counter* counter) {
-    if (counter) counter->impl->decrement();
+    if (counter) counter->impl.decrement();
 }
 
-int counter_get(const Counter* counter) {
-    return counter ? counter->impl->get() : 0;
+int (counter_get)(const Counter* counter) {
+    return counter ? counter->impl.get() : 0;
 }
 
 } // extern "C"
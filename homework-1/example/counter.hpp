@@ -8,6 +8,12 @@ extern "C" {
 // Непрозрачный тип — в C это будет просто указатель
 typedef struct Counter Counter;
 
+// Начало объекта Counter: его можно читать без вызова функции (COUNTER_INLINE_GETTERS).
+// Остальное содержимое Counter скрыто, тип для C остаётся неполным.
+typedef struct CounterState {
+    int value;
+} CounterState;
+
 // C-совместимый интерфейс
 Counter* counter_create(int initial_value);
 void counter_destroy(Counter* counter);
@@ -16,6 +22,14 @@ void counter_increment(Counter* counter);
 void counter_decrement(Counter* counter);
 int  counter_get(const Counter* counter);
 
+#ifdef COUNTER_INLINE_GETTERS
+static inline int counter_get_inline(const Counter* counter) {
+    return counter ? ((const CounterState*)(const void*)counter)->value : 0;
+}
+// (counter_get)(c) по-прежнему вызывает функцию из библиотеки.
+#define counter_get(counter) counter_get_inline(counter)
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,182 @@
+#ifndef GROUP_TABLE_HPP
+#define GROUP_TABLE_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "storage.hpp"
+
+// Группы задач для массовых операций (холодные данные планировщика).
+//
+// Группа — метка вызывающего кода (uint32_t, 0 — без группы). Её задачи связаны
+// двусвязным списком через слоты, поэтому обход группы стоит O(размера группы),
+// а вход и выход задачи — O(1). Метка -> запись группы — открытая адресация
+// с линейным пробированием, удаление обратным сдвигом; запись живёт, пока в группе
+// есть задачи.
+//
+// Обычная сборка растит таблицу по числу групп (при set_group), в сборке SCHEDULER_STATIC
+// она сразу рассчитана на max_tasks групп.
+class GroupTable {
+public:
+    static const uint32_t kNone = 0xFFFFFFFFu;
+
+#ifdef SCHEDULER_STATIC
+    static constexpr size_t storage_bytes(uint32_t slots) {
+        return Arena::bytes<Link>(slots) + Arena::bytes<Group>(slots + 1) +
+               Arena::bytes<uint32_t>(buckets_for(slots));
+    }
+
+    void attach(Arena& arena, uint32_t slots) {
+        links_.attach(arena.take<Link>(slots), slots);
+        groups_.attach(arena.take<Group>(slots + 1), slots + 1);
+        groups_.resize(1);
+        const size_t buckets = buckets_for(slots);
+        buckets_.attach(arena.take<uint32_t>(buckets), buckets);
+        buckets_.resize(buckets, 0);
+    }
+#endif
+
+    // Вызывается при росте таблицы задач.
+    void reserve(uint32_t slots) { links_.resize(slots); }
+
+    // Метка группы задачи или 0.
+    uint32_t tag(uint32_t slot) const { return groups_.empty() ? 0 : groups_[links_[slot].group].tag; }
+
+    // Переносит задачу в группу tag (0 — убирает из группы).
+    void join(uint32_t slot, uint32_t tag) {
+        leave(slot);
+        if (tag == 0) return;
+#ifndef SCHEDULER_STATIC
+        if (groups_.empty()) groups_.resize(1);
+        if (buckets_.size() < buckets_for(uint32_t(groups_.size()))) rehash(buckets_for(uint32_t(groups_.size())));
+#endif
+        size_t b = bucket(tag);
+        while (buckets_[b] != 0 && groups_[buckets_[b]].tag != tag) b = (b + 1) & (buckets_.size() - 1);
+        uint32_t g = buckets_[b];
+        if (g == 0) {
+            if (free_ != 0) {
+                g = free_;
+                free_ = groups_[g].head;
+            } else {
+                g = uint32_t(groups_.size());
+                groups_.resize(groups_.size() + 1);
+            }
+            groups_[g].tag = tag;
+            groups_[g].head = kNone;
+            groups_[g].count = 0;
+            buckets_[b] = g;
+        }
+        Group& group = groups_[g];
+        Link& l = links_[slot];
+        l.group = g;
+        l.prev = kNone;
+        l.next = group.head;
+        if (group.head != kNone) links_[group.head].prev = slot;
+        group.head = slot;
+        group.count++;
+    }
+
+    void leave(uint32_t slot) {
+        Link& l = links_[slot];
+        if (l.group == 0) return;
+        Group& group = groups_[l.group];
+        if (l.prev != kNone) links_[l.prev].next = l.next;
+        else group.head = l.next;
+        if (l.next != kNone) links_[l.next].prev = l.prev;
+        if (--group.count == 0) erase(l.group);
+        l.group = 0;
+    }
+
+    // Число задач в группе tag.
+    size_t size(uint32_t tag) const {
+        const uint32_t g = find(tag);
+        return g == 0 ? 0 : groups_[g].count;
+    }
+
+    // Вызывает f(slot) для каждой задачи группы. f может убрать из группы текущую задачу,
+    // но не другие.
+    template <class F>
+    void for_each(uint32_t tag, F f) const {
+        const uint32_t g = find(tag);
+        if (g == 0) return;
+        for (uint32_t slot = groups_[g].head; slot != kNone;) {
+            const uint32_t next = links_[slot].next;
+            f(slot);
+            slot = next;
+        }
+    }
+
+    // Убирает из группы все задачи разом.
+    void dissolve(uint32_t tag) {
+        const uint32_t g = find(tag);
+        if (g == 0) return;
+        for (uint32_t slot = groups_[g].head; slot != kNone; slot = links_[slot].next) links_[slot].group = 0;
+        erase(g);
+    }
+
+private:
+    struct Link {
+        uint32_t next = kNone;
+        uint32_t prev = kNone;
+        uint32_t group = 0;     // индекс записи в groups_, 0 — без группы
+    };
+
+    struct Group {
+        uint32_t tag;
+        uint32_t head;          // для свободной записи — следующая свободная
+        uint32_t count;
+    };
+
+    // Степень двойки, не меньше удвоенного числа групп: заполнение не выше половины.
+    static constexpr size_t buckets_for(uint32_t groups, size_t n = 16) {
+        return n >= 2 * (size_t(groups) + 1) ? n : buckets_for(groups, 2 * n);
+    }
+
+    size_t bucket(uint32_t tag) const { return (tag * 2654435761u) & (buckets_.size() - 1); }
+
+    uint32_t find(uint32_t tag) const {
+        if (tag == 0 || buckets_.empty()) return 0;
+        for (size_t b = bucket(tag); buckets_[b] != 0; b = (b + 1) & (buckets_.size() - 1)) {
+            if (groups_[buckets_[b]].tag == tag) return buckets_[b];
+        }
+        return 0;
+    }
+
+    void erase(uint32_t g) {
+        const size_t mask = buckets_.size() - 1;
+        size_t i = bucket(groups_[g].tag);
+        while (buckets_[i] != g) i = (i + 1) & mask;
+        // Сдвигаем назад записи цепочки, которые иначе стали бы недостижимы.
+        for (size_t j = (i + 1) & mask; buckets_[j] != 0; j = (j + 1) & mask) {
+            const size_t home = bucket(groups_[buckets_[j]].tag);
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                buckets_[i] = buckets_[j];
+                i = j;
+            }
+        }
+        buckets_[i] = 0;
+        groups_[g].tag = 0;
+        groups_[g].head = free_;
+        free_ = g;
+    }
+
+#ifndef SCHEDULER_STATIC
+    void rehash(size_t buckets) {
+        std::vector<uint32_t> fresh(buckets, 0);
+        for (size_t b = 0; b < buckets_.size(); b++) {
+            if (buckets_[b] == 0) continue;
+            size_t i = (groups_[buckets_[b]].tag * 2654435761u) & (buckets - 1);
+            while (fresh[i] != 0) i = (i + 1) & (buckets - 1);
+            fresh[i] = buckets_[b];
+        }
+        buckets_.swap(fresh);
+    }
+#endif
+
+    Array<Link> links_;         // по слоту задачи
+    Array<Group> groups_;       // [0] — "без группы"
+    Array<uint32_t> buckets_;   // индексы записей, 0 — пусто
+    uint32_t free_ = 0;         // список свободных записей через head
+};
+
+#endif // GROUP_TABLE_HPP
@@ -0,0 +1,140 @@
+#ifndef NAME_TABLE_HPP
+#define NAME_TABLE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "scheduler.hpp"
+#include "storage.hpp"
+
+// Интернированные имена задач (холодные данные планировщика).
+//
+// Одинаковые имена хранятся один раз, задача держит только 4-байтовый индекс записи.
+// Записи со счётчиком ссылок освобождаются, когда уходит последняя задача с этим именем.
+// Поиск — открытая адресация с линейным пробированием по хэшу имени; удаление — обратным
+// сдвигом, без надгробий. Индекс 0 — пустое имя, оно не хранится.
+//
+// Обычная сборка растит таблицу по числу различных имён (при добавлении задачи),
+// в сборке SCHEDULER_STATIC она сразу рассчитана на max_tasks различных имён.
+class NameTable {
+public:
+#ifdef SCHEDULER_STATIC
+    static constexpr size_t storage_bytes(uint32_t names) {
+        return Arena::bytes<Entry>(names + 1) + Arena::bytes<uint32_t>(buckets_for(names));
+    }
+
+    void attach(Arena& arena, uint32_t names) {
+        entries_.attach(arena.take<Entry>(names + 1), names + 1);
+        entries_.resize(1);
+        const size_t buckets = buckets_for(names);
+        buckets_.attach(arena.take<uint32_t>(buckets), buckets);
+        buckets_.resize(buckets, 0);
+    }
+#endif
+
+    // Индекс записи с этим именем (обрезанным до SCHEDULER_NAME_LEN - 1), счётчик ссылок +1.
+    uint32_t intern(const char* name) {
+        char key[SCHEDULER_NAME_LEN] = {};
+        size_t n = 0;
+        for (; name && n + 1 < SCHEDULER_NAME_LEN && name[n]; n++) key[n] = name[n];
+        if (n == 0) return 0;
+#ifndef SCHEDULER_STATIC
+        if (entries_.empty()) entries_.resize(1);
+        if (buckets_.size() < buckets_for(uint32_t(entries_.size()))) rehash(buckets_for(uint32_t(entries_.size())));
+#endif
+        const uint32_t h = hash(key);
+        size_t i = h & (buckets_.size() - 1);
+        for (; buckets_[i] != 0; i = (i + 1) & (buckets_.size() - 1)) {
+            Entry& e = entries_[buckets_[i]];
+            if (e.hash == h && std::memcmp(e.name, key, SCHEDULER_NAME_LEN) == 0) {
+                e.refs++;
+                return buckets_[i];
+            }
+        }
+        uint32_t index;
+        if (free_ != 0) {
+            index = free_;
+            free_ = entries_[index].refs;
+        } else {
+            index = uint32_t(entries_.size());
+            entries_.resize(entries_.size() + 1);
+        }
+        Entry& e = entries_[index];
+        std::memcpy(e.name, key, SCHEDULER_NAME_LEN);
+        e.hash = h;
+        e.refs = 1;
+        buckets_[i] = index;
+        return index;
+    }
+
+    void release(uint32_t index) {
+        if (index == 0 || --entries_[index].refs > 0) return;
+        erase_bucket(index);
+        entries_[index].refs = free_;     // у свободной записи refs — следующая в списке
+        free_ = index;
+    }
+
+    // Имя, дополненное нулями до SCHEDULER_NAME_LEN; для индекса 0 — пустое.
+    // Указатель действителен до следующего intern (массив записей может переехать).
+    const char* get(uint32_t index) const {
+        static const char empty[SCHEDULER_NAME_LEN] = {};
+        return index == 0 ? empty : entries_[index].name;
+    }
+
+private:
+    struct Entry {
+        char name[SCHEDULER_NAME_LEN];
+        uint32_t hash;
+        uint32_t refs;
+    };
+
+    // Степень двойки, не меньше удвоенного числа имён: заполнение не выше половины.
+    static constexpr size_t buckets_for(uint32_t names, size_t n = 16) {
+        return n >= 2 * (size_t(names) + 1) ? n : buckets_for(names, 2 * n);
+    }
+
+    // FNV-1a по всем байтам имени (хвост — нули).
+    static uint32_t hash(const char* key) {
+        uint32_t h = 2166136261u;
+        for (size_t i = 0; i < SCHEDULER_NAME_LEN && key[i]; i++) {
+            h ^= uint8_t(key[i]);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    void erase_bucket(uint32_t index) {
+        const size_t mask = buckets_.size() - 1;
+        size_t i = entries_[index].hash & mask;
+        while (buckets_[i] != index) i = (i + 1) & mask;
+        // Сдвигаем назад записи цепочки, которые иначе стали бы недостижимы.
+        for (size_t j = (i + 1) & mask; buckets_[j] != 0; j = (j + 1) & mask) {
+            const size_t home = entries_[buckets_[j]].hash & mask;
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                buckets_[i] = buckets_[j];
+                i = j;
+            }
+        }
+        buckets_[i] = 0;
+    }
+
+#ifndef SCHEDULER_STATIC
+    void rehash(size_t buckets) {
+        std::vector<uint32_t> fresh(buckets, 0);
+        for (size_t b = 0; b < buckets_.size(); b++) {
+            if (buckets_[b] == 0) continue;
+            size_t i = entries_[buckets_[b]].hash & (buckets - 1);
+            while (fresh[i] != 0) i = (i + 1) & (buckets - 1);
+            fresh[i] = buckets_[b];
+        }
+        buckets_.swap(fresh);
+    }
+#endif
+
+    Array<Entry> entries_;      // [0] — пустое имя
+    Array<uint32_t> buckets_;   // индексы записей, 0 — пусто
+    uint32_t free_ = 0;         // список свободных записей через refs
+};
+
+#endif // NAME_TABLE_HPP
@@ -0,0 +1,55 @@
+#ifndef PROCESS_LOCK_HPP
+#define PROCESS_LOCK_HPP
+
+#include <errno.h>
+#include <pthread.h>
+
+// Межпроцессная блокировка планировщика в разделяемой памяти (сборка SCHEDULER_SHARED).
+//
+// pthread-мьютекс с атрибутами PTHREAD_PROCESS_SHARED и PTHREAD_MUTEX_ROBUST лежит прямо
+// в сегменте рядом с данными, поэтому его видят все процессы, отобразившие сегмент,
+// по любым адресам. Если процесс умер, держа блокировку, следующий lock() получит её,
+// но операция умершего могла остаться недоделанной: блокировка помечается испорченной,
+// и lock() с этого момента возвращает false во всех процессах.
+class ProcessLock {
+public:
+    // Вызывается один раз, создателем сегмента, до того как к нему подключатся другие.
+    bool init() {
+        pthread_mutexattr_t attr;
+        if (pthread_mutexattr_init(&attr) != 0) return false;
+        bool ok = pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED) == 0 &&
+                  pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST) == 0 &&
+                  pthread_mutex_init(&mutex_, &attr) == 0;
+        pthread_mutexattr_destroy(&attr);
+        broken_ = !ok;
+        return ok;
+    }
+
+    void destroy() { pthread_mutex_destroy(&mutex_); }
+
+    // false — блокировка не взята: сегмент испорчен.
+    bool lock() {
+        const int rc = pthread_mutex_lock(&mutex_);
+        if (rc == EOWNERDEAD) {
+            broken_ = true;
+            pthread_mutex_consistent(&mutex_);
+        } else if (rc != 0) {
+            return false;
+        }
+        if (broken_) {
+            pthread_mutex_unlock(&mutex_);
+            return false;
+        }
+        return true;
+    }
+
+    void unlock() { pthread_mutex_unlock(&mutex_); }
+
+    bool broken() const { return broken_; }
+
+private:
+    pthread_mutex_t mutex_;
+    bool broken_ = true;        // до init() блокировки нет
+};
+
+#endif // PROCESS_LOCK_HPP
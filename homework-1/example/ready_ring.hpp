@@ -0,0 +1,66 @@
+#ifndef READY_RING_HPP
+#define READY_RING_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "storage.hpp"
+
+// Очередь готовых задач одного класса приоритета: кольцевой буфер слотов.
+//
+// Слот стоит в очереди готовых не более одного раза (флаг pending задачи), поэтому
+// кольцу с ёмкостью не меньше числа слотов переполнение не грозит, и push не проверяет место.
+// Обычная сборка выделяет кольцо при первом использовании класса и растит вместе с таблицей
+// задач, в сборке SCHEDULER_STATIC оно сразу на max_tasks слотов.
+class ReadyRing {
+public:
+#ifdef SCHEDULER_STATIC
+    static constexpr size_t storage_bytes(uint32_t slots) { return Arena::bytes<uint32_t>(slots); }
+
+    void attach(Arena& arena, uint32_t slots) {
+        slots_.attach(arena.take<uint32_t>(slots), slots);
+        slots_.resize(slots);
+    }
+#else
+    // Ёмкость не меньше slots (выделяется сразу capacity). Кольцо разворачивается в новом буфере.
+    void reserve(size_t slots, size_t capacity) {
+        if (slots_.size() >= slots) return;
+        std::vector<uint32_t> ring(capacity);
+        for (size_t i = 0; i < size_; i++) ring[i] = slots_[(head_ + i) % slots_.size()];
+        slots_.swap(ring);
+        head_ = 0;
+    }
+#endif
+
+    size_t capacity() const { return slots_.size(); }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    void push(uint32_t slot) {
+        size_t tail = head_ + size_;
+        if (tail >= slots_.size()) tail -= slots_.size();
+        slots_[tail] = slot;
+        size_++;
+    }
+
+    // Слот на ahead позиций от начала (ahead < size()), для упреждающей загрузки.
+    uint32_t peek(size_t ahead) const {
+        size_t i = head_ + ahead;
+        if (i >= slots_.size()) i -= slots_.size();
+        return slots_[i];
+    }
+
+    uint32_t pop() {
+        const uint32_t slot = slots_[head_];
+        head_ = head_ + 1 == slots_.size() ? 0 : head_ + 1;
+        size_--;
+        return slot;
+    }
+
+private:
+    Array<uint32_t> slots_;
+    size_t head_ = 0;
+    size_t size_ = 0;
+};
+
+#endif // READY_RING_HPP
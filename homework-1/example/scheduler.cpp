@@ -0,0 +1,546 @@
+#include "scheduler.hpp"
+
+#include <cstring>
+#include <new>
+
+#include "scheduler_impl.hpp"
+#include "trace_format.hpp"
+
+#ifdef SCHEDULER_MPSC
+#include "submission_queue.hpp"
+
+#ifndef SCHEDULER_MPSC_CAPACITY
+#define SCHEDULER_MPSC_CAPACITY 256
+#endif
+
+static_assert((SCHEDULER_MPSC_CAPACITY & (SCHEDULER_MPSC_CAPACITY - 1)) == 0,
+              "SCHEDULER_MPSC_CAPACITY must be a power of two");
+#endif
+
+#ifdef SCHEDULER_SHARED
+#if !defined(SCHEDULER_STATIC) || defined(SCHEDULER_MPSC) || defined(SCHEDULER_TRACE)
+#error "SCHEDULER_SHARED needs SCHEDULER_STATIC and cannot be combined with SCHEDULER_MPSC or SCHEDULER_TRACE"
+#endif
+#include "process_lock.hpp"
+#endif
+
+// Реализация лежит прямо в непрозрачной структуре (как в counter.cpp).
+// Первым полем — публичные счётчики для inline-геттеров из scheduler.hpp;
+// их обновляет каждый вызов, который меняет состояние.
+struct Scheduler {
+    SchedulerCounters counters;
+    SchedulerImpl impl;
+#ifdef SCHEDULER_MPSC
+    // Команды add/remove/set_catchup из любых потоков; применяются в scheduler_update.
+    SubmissionQueue<SchedulerImpl> submissions{SCHEDULER_MPSC_CAPACITY};
+#endif
+#ifdef SCHEDULER_TRACE
+    strace::Writer trace_writer;
+#endif
+#ifdef SCHEDULER_SHARED
+    // Блок в разделяемой памяти: по этим полям scheduler_attach проверяет, что блок создан
+    // той же сборкой библиотеки. magic пишется последним, когда всё остальное готово.
+    uint32_t magic = 0;
+    uint32_t layout = sizeof(Scheduler);
+    size_t required = 0;
+    mutable ProcessLock lock;
+#endif
+
+    Scheduler() : counters() {}
+#ifdef SCHEDULER_STATIC
+    Scheduler(Arena& arena, uint32_t max_tasks) : counters(), impl(arena, max_tasks) {
+#ifdef SCHEDULER_MPSC
+        submissions.attach(arena);
+        submissions.refill(impl);
+#endif
+    }
+#endif
+
+    void publish() {
+        counters.task_count = impl.task_count();
+        counters.ready_count = impl.ready_count();
+    }
+
+    // Трасса вызовов (сборка SCHEDULER_TRACE); без неё tracing() — константа false,
+    // и код записи компилятор выбрасывает.
+    bool tracing() const {
+#ifdef SCHEDULER_TRACE
+        return trace_writer.is_open();
+#else
+        return false;
+#endif
+    }
+
+    void trace(uint8_t op, uint32_t id, uint32_t arg, uint32_t result, uint64_t time,
+               const char* name = nullptr, uint8_t policy = 0) {
+#ifdef SCHEDULER_TRACE
+        if (!trace_writer.is_open()) return;
+        strace::Record r;
+        r.op = op;
+        r.policy = policy;
+        r.id = id;
+        r.arg = arg;
+        r.result = result;
+        r.time = time;
+        for (size_t n = 0; name && n + 1 < SCHEDULER_NAME_LEN && name[n]; n++) r.name[n] = name[n];
+        trace_writer.add(r);
+#else
+        (void)op, (void)id, (void)arg, (void)result, (void)time, (void)name, (void)policy;
+#endif
+    }
+
+    // У drain на один аргумент больше, чем полей в записи: max_cost кладётся в начало имени.
+    void trace_drain(uint32_t max_tasks, uint32_t n, uint64_t hash, uint64_t max_cost) {
+#ifdef SCHEDULER_TRACE
+        if (!trace_writer.is_open()) return;
+        strace::Record r;
+        r.op = strace::kDrain;
+        r.arg = max_tasks;
+        r.result = n;
+        r.time = hash;
+        std::memcpy(r.name, &max_cost, sizeof(max_cost));
+        trace_writer.add(r);
+#else
+        (void)max_tasks, (void)n, (void)hash, (void)max_cost;
+#endif
+    }
+
+#ifdef SCHEDULER_MPSC
+    // Наблюдатель очереди команд: в сборке MPSC команды других потоков попадают в трассу,
+    // когда поток цикла применяет их в scheduler_update, — однопоточно и в порядке применения.
+    // add записывается как kActivate уже зарезервированного id, а резервирование — как kReserve,
+    // чтобы воспроизведение выдало те же id.
+    void applied(const SubmissionQueue<SchedulerImpl>::Command& c, bool ok) {
+        if (!tracing()) return;
+        typedef SubmissionQueue<SchedulerImpl> Queue;
+        const uint32_t rc = ok ? 0 : uint32_t(-1);
+        switch (c.op) {
+        case Queue::kAdd: trace(strace::kActivate, c.id, c.period_ms, rc, c.next_run_ms, c.name); break;
+        case Queue::kRemove: trace(strace::kRemove, c.id, 0, rc, 0); break;
+        case Queue::kCatchup:
+            trace(strace::kCatchup, c.id, uint32_t(c.next_run_ms), rc, 0, nullptr, uint8_t(c.period_ms));
+            break;
+        case Queue::kGroup: trace(strace::kGroup, c.id, c.period_ms, rc, 0); break;
+        case Queue::kPriority:
+            trace(strace::kPriority, c.id, uint32_t(c.next_run_ms), rc, 0, nullptr, uint8_t(c.period_ms));
+            break;
+        case Queue::kReport: trace(strace::kReport, c.id, c.period_ms, rc, 0); break;
+        }
+    }
+
+    void reserved(uint32_t id) { trace(strace::kReserve, id, 0, 0, 0); }
+#endif
+};
+
+namespace {
+
+// Вызов под блокировкой планировщика (сборка SCHEDULER_SHARED: вызовы из всех процессов
+// и потоков идут по одному). В остальных сборках — только проверка на NULL.
+class CallGuard {
+public:
+    explicit CallGuard(const Scheduler* scheduler) : scheduler_(scheduler) {
+#ifdef SCHEDULER_SHARED
+        if (scheduler_ && !scheduler_->lock.lock()) scheduler_ = nullptr;
+#endif
+    }
+    CallGuard(const CallGuard&) = delete;
+    CallGuard& operator=(const CallGuard&) = delete;
+
+    ~CallGuard() {
+#ifdef SCHEDULER_SHARED
+        if (scheduler_) scheduler_->lock.unlock();
+#endif
+    }
+
+    bool ok() const { return scheduler_ != nullptr; }
+
+private:
+    const Scheduler* scheduler_;
+};
+
+} // namespace
+
+#ifdef SCHEDULER_STATIC
+
+namespace {
+
+const uint32_t kMaxTasks = SCHEDULER_MAX_TASKS;
+
+// Блок: Scheduler, затем массивы в порядке их взятия из арены.
+constexpr size_t required_bytes(uint32_t max_tasks) {
+    return Arena::round(sizeof(Scheduler)) + SchedulerImpl::storage_bytes(max_tasks)
+#ifdef SCHEDULER_MPSC
+           + SubmissionQueue<SchedulerImpl>::storage_bytes(SCHEDULER_MPSC_CAPACITY)
+#endif
+        ;
+}
+
+#ifdef SCHEDULER_SHARED
+// "SHR" и движок: блок размечен scheduler_create_in сборки с тем же движком.
+#if defined(SCHEDULER_ENGINE_HEAP)
+const uint32_t kMagic = 0x48524853u;    // "SHRH"
+#elif defined(SCHEDULER_ENGINE_SORTED)
+const uint32_t kMagic = 0x53524853u;    // "SHRS"
+#else
+const uint32_t kMagic = 0x57524853u;    // "SHRW"
+#endif
+#endif
+
+alignas(std::max_align_t) unsigned char g_memory[required_bytes(kMaxTasks)];
+bool g_memory_used = false;
+
+} // namespace
+
+extern "C" {
+
+size_t scheduler_required_bytes(uint32_t max_tasks) {
+    return required_bytes(max_tasks);
+}
+
+Scheduler* scheduler_create_in(void* memory, size_t bytes, uint32_t max_tasks) {
+    if (!memory || max_tasks == 0 || max_tasks > (1u << 24)) return nullptr;
+    if (bytes < required_bytes(max_tasks)) return nullptr;
+    Arena arena(memory, bytes);
+    Scheduler* scheduler = arena.take<Scheduler>(1);
+    if (!scheduler) return nullptr;
+    new (scheduler) Scheduler(arena, max_tasks);
+#ifdef SCHEDULER_SHARED
+    if (!scheduler->lock.init()) {
+        scheduler->~Scheduler();
+        return nullptr;
+    }
+    scheduler->required = required_bytes(max_tasks);
+    __atomic_store_n(&scheduler->magic, kMagic, __ATOMIC_RELEASE);
+#endif
+    return scheduler;
+}
+
+#ifdef SCHEDULER_SHARED
+Scheduler* scheduler_attach(void* memory, size_t bytes) {
+    if (!memory || (reinterpret_cast<uintptr_t>(memory) & (Arena::kAlign - 1)) != 0) return nullptr;
+    if (bytes < sizeof(Scheduler)) return nullptr;
+    Scheduler* scheduler = static_cast<Scheduler*>(memory);
+    if (__atomic_load_n(&scheduler->magic, __ATOMIC_ACQUIRE) != kMagic) return nullptr;
+    if (scheduler->layout != sizeof(Scheduler) || bytes < scheduler->required) return nullptr;
+    return scheduler;
+}
+#endif
+
+Scheduler* scheduler_create(void) {
+    if (g_memory_used) return nullptr;
+    Scheduler* scheduler = scheduler_create_in(g_memory, sizeof(g_memory), kMaxTasks);
+    if (scheduler) g_memory_used = true;
+    return scheduler;
+}
+
+void scheduler_destroy(Scheduler* scheduler) {
+    if (!scheduler) return;
+#ifdef SCHEDULER_SHARED
+    __atomic_store_n(&scheduler->magic, 0u, __ATOMIC_RELEASE);
+    scheduler->lock.destroy();
+#endif
+    scheduler->~Scheduler();
+    if (static_cast<void*>(scheduler) == g_memory) g_memory_used = false;
+}
+
+#else
+
+extern "C" {
+
+Scheduler* scheduler_create(void) {
+    Scheduler* scheduler = new (std::nothrow) Scheduler;
+#ifdef SCHEDULER_MPSC
+    if (!scheduler) return nullptr;
+    try {
+        if (!scheduler->submissions.allocate()) throw std::bad_alloc();
+        scheduler->submissions.refill(scheduler->impl);
+    } catch (...) {
+        delete scheduler;
+        return nullptr;
+    }
+#endif
+    return scheduler;
+}
+
+void scheduler_destroy(Scheduler* scheduler) {
+    delete scheduler;
+}
+
+#endif // SCHEDULER_STATIC
+
+uint32_t scheduler_add_task(Scheduler* scheduler, const char* name, uint32_t period_ms, uint64_t next_run_ms) {
+    CallGuard guard(scheduler);
+    if (!guard.ok()) return 0;
+#ifdef SCHEDULER_MPSC
+    return scheduler->submissions.add(name, period_ms, next_run_ms);
+#else
+    // Исключения не должны пересекать границу C ABI.
+    try {
+        const uint32_t id = scheduler->impl.add_task(name, period_ms, next_run_ms);
+        scheduler->publish();
+        scheduler->trace(strace::kAdd, id, period_ms, 0, next_run_ms, name);
+        return id;
+    } catch (...) {
+        return 0;
+    }
+#endif
+}
+
+int scheduler_remove_task(Scheduler* scheduler, uint32_t id) {
+#ifdef SCHEDULER_MPSC
+    return scheduler && scheduler->submissions.remove(id) ? 0 : -1;
+#else
+    CallGuard guard(scheduler);
+    if (!guard.ok()) return -1;
+    const int rc = scheduler->impl.remove_task(id) ? 0 : -1;
+    scheduler->publish();
+    scheduler->trace(strace::kRemove, id, 0, uint32_t(rc), 0);
+    return rc;
+#endif
+}
+
+int scheduler_get_task(const Scheduler* scheduler, uint32_t id, SchedulerTaskInfo* info) {
+    CallGuard guard(scheduler);
+    return guard.ok() && info && scheduler->impl.get_task(id, *info) ? 0 : -1;
+}
+
+const char* scheduler_task_name(const Scheduler* scheduler, uint32_t id) {
+    CallGuard guard(scheduler);
+    return guard.ok() ? scheduler->impl.task_name(id) : nullptr;
+}
+
+size_t (scheduler_task_count)(const Scheduler* scheduler) {
+    CallGuard guard(scheduler);
+    return guard.ok() ? scheduler->impl.task_count() : 0;
+}
+
+int scheduler_set_catchup(Scheduler* scheduler, uint32_t id, SchedulerCatchup policy, uint32_t max_runs) {
+#ifdef SCHEDULER_MPSC
+    if (policy > SCHEDULER_CATCHUP_BOUNDED || (policy == SCHEDULER_CATCHUP_BOUNDED && max_runs == 0)) return -1;
+    return scheduler && scheduler->submissions.set_catchup(id, policy, max_runs) ? 0 : -1;
+#else
+    CallGuard guard(scheduler);
+    if (!guard.ok()) return -1;
+    const int rc = scheduler->impl.set_catchup(id, policy, max_runs) ? 0 : -1;
+    scheduler->trace(strace::kCatchup, id, max_runs, uint32_t(rc), 0, nullptr, uint8_t(policy));
+    return rc;
+#endif
+}
+
+int scheduler_set_priority(Scheduler* scheduler, uint32_t id, SchedulerPriority priority, uint32_t cost) {
+#ifdef SCHEDULER_MPSC
+    if (uint32_t(priority) >= SCHEDULER_PRIORITY_COUNT) return -1;
+    return scheduler && scheduler->submissions.set_priority(id, priority, cost) ? 0 : -1;
+#else
+    CallGuard guard(scheduler);
+    if (!guard.ok()) return -1;
+    // Первая задача класса выделяет его очередь готовых.
+    int rc;
+    try {
+        rc = scheduler->impl.set_priority(id, priority, cost) ? 0 : -1;
+    } catch (...) {
+        rc = -1;
+    }
+    scheduler->trace(strace::kPriority, id, cost, uint32_t(rc), 0, nullptr, uint8_t(priority));
+    return rc;
+#endif
+}
+
+int scheduler_set_group(Scheduler* scheduler, uint32_t id, uint32_t group) {
+#ifdef SCHEDULER_MPSC
+    return scheduler && scheduler->submissions.set_group(id, group) ? 0 : -1;
+#else
+    CallGuard guard(scheduler);
+    if (!guard.ok()) return -1;
+    // Запись новой группы может расширить таблицу групп.
+    int rc;
+    try {
+        rc = scheduler->impl.set_group(id, group) ? 0 : -1;
+    } catch (...) {
+        rc = -1;
+    }
+    scheduler->trace(strace::kGroup, id, group, uint32_t(rc), 0);
+    return rc;
+#endif
+}
+
+int scheduler_report_run(Scheduler* scheduler, uint32_t id, uint32_t duration) {
+#ifdef SCHEDULER_MPSC
+    return scheduler && scheduler->submissions.report_run(id, duration) ? 0 : -1;
+#else
+    CallGuard guard(scheduler);
+    if (!guard.ok()) return -1;
+    const int rc = scheduler->impl.report_run(id, duration) ? 0 : -1;
+    scheduler->trace(strace::kReport, id, duration, uint32_t(rc), 0);
+    return rc;
+#endif
+}
+
+int scheduler_get_task_stats(const Scheduler* scheduler, uint32_t id, SchedulerTaskStats* stats) {
+    CallGuard guard(scheduler);
+    return guard.ok() && stats && scheduler->impl.task_stats(id, *stats) ? 0 : -1;
+}
+
+size_t scheduler_slowest_tasks(const Scheduler* scheduler, SchedulerTaskStats* stats, size_t max_tasks) {
+    CallGuard guard(scheduler);
+    return guard.ok() && stats ? scheduler->impl.slowest(stats, max_tasks) : 0;
+}
+
+size_t scheduler_group_size(const Scheduler* scheduler, uint32_t group) {
+    CallGuard guard(scheduler);
+    return guard.ok() ? scheduler->impl.group_size(group) : 0;
+}
+
+size_t scheduler_cancel_group(Scheduler* scheduler, uint32_t group) {
+    CallGuard guard(scheduler);
+    if (!guard.ok()) return 0;
+    const size_t n = scheduler->impl.cancel_group(group);
+    scheduler->publish();
+    scheduler->trace(strace::kCancelGroup, 0, group, uint32_t(n), 0);
+    return n;
+}
+
+size_t scheduler_pause_group(Scheduler* scheduler, uint32_t group) {
+    CallGuard guard(scheduler);
+    if (!guard.ok()) return 0;
+    const size_t n = scheduler->impl.pause_group(group);
+    scheduler->trace(strace::kPauseGroup, 0, group, uint32_t(n), 0);
+    return n;
+}
+
+size_t scheduler_resume_group(Scheduler* scheduler, uint32_t group) {
+    CallGuard guard(scheduler);
+    if (!guard.ok()) return 0;
+    const size_t n = scheduler->impl.resume_group(group);
+    scheduler->trace(strace::kResumeGroup, 0, group, uint32_t(n), 0);
+    return n;
+}
+
+size_t scheduler_shift_group(Scheduler* scheduler, uint32_t group, int64_t delta_ms) {
+    CallGuard guard(scheduler);
+    if (!guard.ok()) return 0;
+    const size_t n = scheduler->impl.shift_group(group, delta_ms);
+    scheduler->trace(strace::kShiftGroup, 0, group, uint32_t(n), uint64_t(delta_ms));
+    return n;
+}
+
+void scheduler_update(Scheduler* scheduler, uint64_t now_ms) {
+    CallGuard guard(scheduler);
+    if (!guard.ok()) return;
+#ifdef SCHEDULER_MPSC
+    // Запас id пополняется через reserve(), а он может расширить таблицу задач.
+    try {
+        scheduler->submissions.drain(scheduler->impl, *scheduler);
+    } catch (...) {
+    }
+#endif
+    scheduler->impl.advance_to(now_ms);
+    scheduler->publish();
+    scheduler->trace(strace::kUpdate, 0, 0, 0, now_ms);
+}
+
+int scheduler_next_deadline(const Scheduler* scheduler, uint64_t* deadline_ms) {
+    CallGuard guard(scheduler);
+    if (!guard.ok() || !deadline_ms) return -1;
+    const SchedulerImpl& impl = scheduler->impl;
+#ifdef SCHEDULER_MPSC
+    // Команды из других потоков применит следующий update: он нужен сейчас.
+    if (scheduler->submissions.pending()) {
+        *deadline_ms = impl.now();
+        return 0;
+    }
+#endif
+    if (impl.next_deadline(*deadline_ms)) return 0;
+    *deadline_ms = UINT64_MAX;
+    return -1;
+}
+
+size_t (scheduler_ready_count)(const Scheduler* scheduler) {
+    CallGuard guard(scheduler);
+    return guard.ok() ? scheduler->impl.ready_count() : 0;
+}
+
+size_t scheduler_ready_count_priority(const Scheduler* scheduler, SchedulerPriority priority) {
+    CallGuard guard(scheduler);
+    return guard.ok() ? scheduler->impl.ready_count(priority) : 0;
+}
+
+size_t scheduler_pop_ready(Scheduler* scheduler, uint32_t* ids, size_t max_ids) {
+    CallGuard guard(scheduler);
+    if (!guard.ok() || !ids) return 0;
+    const size_t n = scheduler->impl.pop_ready(ids, max_ids);
+    scheduler->publish();
+    if (scheduler->tracing()) {
+        uint64_t h = strace::kHashSeed;
+        for (size_t i = 0; i < n; i++) h = strace::hash_ids(h, ids[i]);
+        scheduler->trace(strace::kPop, 0, uint32_t(max_ids), uint32_t(n), h);
+    }
+    return n;
+}
+
+size_t scheduler_pop_ready_tasks(Scheduler* scheduler, SchedulerTaskInfo* tasks, size_t max_tasks,
+                                 size_t* remaining) {
+    size_t n = 0;
+    CallGuard guard(scheduler);
+    if (guard.ok() && tasks) {
+        n = scheduler->impl.pop_ready(tasks, max_tasks);
+        scheduler->publish();
+        if (scheduler->tracing()) {
+            uint64_t h = strace::kHashSeed;
+            for (size_t i = 0; i < n; i++) h = strace::hash_ids(h, tasks[i].id);
+            scheduler->trace(strace::kPopTasks, 0, uint32_t(max_tasks), uint32_t(n), h);
+        }
+    }
+    if (remaining) *remaining = guard.ok() ? scheduler->impl.ready_count() : 0;
+    return n;
+}
+
+size_t scheduler_drain(Scheduler* scheduler, SchedulerTaskInfo* tasks, size_t max_tasks, uint64_t max_cost,
+                       uint64_t* spent) {
+    uint64_t cost = 0;
+    size_t n = 0;
+    CallGuard guard(scheduler);
+    if (guard.ok() && tasks) {
+        n = scheduler->impl.drain(tasks, max_tasks, max_cost == 0 ? UINT64_MAX : max_cost, cost);
+        scheduler->publish();
+        if (scheduler->tracing()) {
+            uint64_t h = strace::kHashSeed;
+            for (size_t i = 0; i < n; i++) h = strace::hash_ids(h, tasks[i].id);
+            scheduler->trace_drain(uint32_t(max_tasks), uint32_t(n), h, max_cost == 0 ? UINT64_MAX : max_cost);
+        }
+    }
+    if (spent) *spent = cost;
+    return n;
+}
+
+#ifdef SCHEDULER_TRACE
+
+int scheduler_trace_open(Scheduler* scheduler, const char* path) {
+    // Трасса воспроизводится с нуля, поэтому пишется только для ещё не использованного планировщика.
+#ifdef SCHEDULER_MPSC
+    // Запас id зарезервирован уже при создании: он пишется в начало трассы. Команд от других
+    // потоков к этому моменту быть не должно, иначе часть запаса уже разобрана.
+    if (!scheduler || scheduler->submissions.pending() ||
+        scheduler->impl.slot_count() != scheduler->submissions.spare_count()) {
+        return -1;
+    }
+    if (!scheduler->trace_writer.open(path)) return -1;
+    scheduler->submissions.for_each_spare([scheduler](uint32_t id) { scheduler->reserved(id); });
+    return 0;
+#else
+    if (!scheduler || scheduler->impl.slot_count() != 0) return -1;
+    return scheduler->trace_writer.open(path) ? 0 : -1;
+#endif
+}
+
+void scheduler_trace_flush(Scheduler* scheduler) {
+    if (scheduler) scheduler->trace_writer.flush();
+}
+
+int scheduler_trace_close(Scheduler* scheduler) {
+    return scheduler && scheduler->trace_writer.close() ? 0 : -1;
+}
+
+#endif // SCHEDULER_TRACE
+
+} // extern "C"
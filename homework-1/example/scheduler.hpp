@@ -0,0 +1,257 @@
+#ifndef SCHEDULER_HPP
+#define SCHEDULER_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Максимальная длина имени задачи вместе с завершающим нулём
+#define SCHEDULER_NAME_LEN 32
+
+// Единица времени планировщика — тик: все времена интерфейса (now_ms, period_ms, next_run_ms,
+// deadline_ms) в тиках. По умолчанию тик — миллисекунда; сборка -DSCHEDULER_TICK=us или ns
+// делает его микро- или наносекундой (циклы управления в килогерцы). Время 64-битное
+// и не переполняется (наносекунд хватит на 584 года), а период 32-битный: не длиннее
+// 49 дней при тике в мс, 71 минуты в мкс и 4,2 с в нс.
+#if defined(SCHEDULER_TICK_NS)
+#define SCHEDULER_TICKS_PER_SECOND 1000000000u
+#elif defined(SCHEDULER_TICK_US)
+#define SCHEDULER_TICKS_PER_SECOND 1000000u
+#else
+#define SCHEDULER_TICKS_PER_SECOND 1000u
+#endif
+
+// Время из 32-битного счётчика, который переполняется (таймер МК: в мкс — раз в 71 минуту):
+// продолжает 64-битное время last на разность по модулю 2^32. Верно, если с last прошло
+// меньше 2^32 тиков, то есть счётчик читается хотя бы раз за оборот.
+static inline uint64_t scheduler_time_extend(uint64_t last, uint32_t now32) {
+    return last + (uint32_t)(now32 - (uint32_t)last);
+}
+
+// Непрозрачный тип — в C это будет просто указатель
+typedef struct Scheduler Scheduler;
+
+// Начало объекта Scheduler: счётчики, которые можно читать без вызова функции
+// (SCHEDULER_INLINE_GETTERS). Остальное содержимое скрыто, тип для C остаётся неполным.
+typedef struct SchedulerCounters {
+    size_t task_count;
+    size_t ready_count;
+} SchedulerCounters;
+
+// Политика догона: что делать с периодической задачей, если время прыгнуло
+// через несколько её запусков (или она ещё ждёт в очереди готовых, а запуски наступают).
+// В очереди задача всегда одна; сколько раз её выполнить, говорит SchedulerTaskInfo.runs.
+typedef enum SchedulerCatchup {
+    SCHEDULER_CATCHUP_SKIP = 0,      // один запуск, пропущенные отбрасываются (по умолчанию)
+    SCHEDULER_CATCHUP_COALESCE = 1,  // все пропущенные запуски, одним элементом очереди
+    SCHEDULER_CATCHUP_BOUNDED = 2,   // пропущенные запуски, но не больше max_runs
+} SchedulerCatchup;
+
+// Класс приоритета: у каждого класса своя очередь готовых задач, и извлечение всегда
+// сначала опустошает более срочный класс. Внутри класса порядок прежний — детерминированный
+// (next_run_ms, порядок постановки), так что поток низкоприоритетных задач не задерживает
+// критичные, а критичные между собой не переставляются.
+typedef enum SchedulerPriority {
+    SCHEDULER_PRIORITY_CRITICAL = 0,
+    SCHEDULER_PRIORITY_NORMAL = 1,   // по умолчанию
+    SCHEDULER_PRIORITY_LOW = 2,
+} SchedulerPriority;
+
+#define SCHEDULER_PRIORITY_COUNT 3
+
+// Снимок задачи, который планировщик копирует наружу
+typedef struct SchedulerTaskInfo {
+    uint32_t id;
+    uint32_t period_ms;    // 0 — одноразовая задача
+    uint64_t next_run_ms;
+    uint32_t runs;         // сколько запусков накоплено к выдаче (0 — задача не в очереди готовых)
+    uint32_t catchup;      // SchedulerCatchup
+    uint32_t group;        // 0 — задача не в группе
+    uint32_t paused;       // 1 — группа приостановлена
+    uint32_t priority;     // SchedulerPriority
+    uint32_t cost;         // оценка стоимости выполнения для scheduler_drain
+    char name[SCHEDULER_NAME_LEN];
+} SchedulerTaskInfo;
+
+// Статистика выполнения задачи по отчётам вызывающего кода (scheduler_report_run)
+typedef struct SchedulerTaskStats {
+    uint32_t id;
+    uint32_t reports;      // сколько выполнений сообщено
+    uint32_t mean;         // скользящее среднее длительности (EWMA, вес нового замера 1/8), округлённое
+    uint32_t max;          // самая долгая длительность
+    uint32_t overruns;     // сколько раз длительность превысила оценку стоимости (cost)
+} SchedulerTaskStats;
+
+// C-совместимый интерфейс
+Scheduler* scheduler_create(void);
+void scheduler_destroy(Scheduler* scheduler);
+
+#ifdef SCHEDULER_STATIC
+// Сборка без кучи (-DSCHEDULER_STATIC=ON в CMake): ёмкость фиксирована, вся память планировщика —
+// один блок. scheduler_create() отдаёт единственный экземпляр на SCHEDULER_MAX_TASKS задач
+// из статического буфера библиотеки (его размер виден в map-файле при линковке) и NULL
+// при повторном вызове до scheduler_destroy.
+
+// Точный размер блока для max_tasks задач.
+size_t scheduler_required_bytes(uint32_t max_tasks);
+// Создаёт планировщик в памяти вызывающего кода: блок не меньше scheduler_required_bytes(max_tasks),
+// выровненный как malloc (max_align_t). NULL, если блок мал или не выровнен.
+// scheduler_destroy() блок не освобождает.
+Scheduler* scheduler_create_in(void* memory, size_t bytes, uint32_t max_tasks);
+#endif
+
+#ifdef SCHEDULER_SHARED
+// Разделяемая сборка (-DSCHEDULER_SHARED=ON, вместе с SCHEDULER_STATIC): блок scheduler_create_in
+// можно положить в разделяемую память (mmap MAP_SHARED, shm_open) и работать с одним планировщиком
+// из нескольких процессов. Внутри блока только смещения, поэтому каждый процесс может отобразить
+// его по своему адресу. Все вызовы идут под межпроцессной блокировкой из того же блока.
+// Если процесс умер посреди вызова, блок считается испорченным: вызовы во всех процессах
+// с этого момента ведут себя как для NULL (0, -1, пустой результат).
+// Указатель scheduler_task_name действителен только до конца вызова и может измениться
+// другим процессом сразу после него — для имени используйте scheduler_get_task.
+// Inline-геттеры (SCHEDULER_INLINE_GETTERS) читают счётчики без блокировки.
+
+// Подключается к блоку, размеченному scheduler_create_in в другом процессе (или в этом же по
+// другому адресу): memory — начало блока в этом процессе, bytes — размер отображения.
+// NULL, если блок не размечен, создан другой сборкой библиотеки или отображён не целиком.
+// scheduler_destroy вызывает один процесс, последним: после него блок не размечен.
+Scheduler* scheduler_attach(void* memory, size_t bytes);
+#endif
+
+// Сборка SCHEDULER_MPSC: scheduler_add_task, scheduler_remove_task, scheduler_set_catchup,
+// scheduler_set_group, scheduler_set_priority и scheduler_report_run можно вызывать из любых
+// потоков. Они только кладут команду в lock-free очередь, а применяются команды в начале
+// следующего scheduler_update. Поэтому remove/set_*/report возвращают 0, если команда принята
+// (а не если задача найдена), а -1 и 0 от add означают, что очередь или запас id исчерпаны
+// до следующего такта. Остальные функции вызывает только поток, который ведёт время.
+
+// Возвращает id задачи (> 0) или 0 при ошибке. Имя обрезается до SCHEDULER_NAME_LEN - 1.
+uint32_t scheduler_add_task(Scheduler* scheduler, const char* name, uint32_t period_ms, uint64_t next_run_ms);
+// 0 — задача удалена, -1 — задачи с таким id нет
+int scheduler_remove_task(Scheduler* scheduler, uint32_t id);
+// 0 — info заполнен, -1 — задачи с таким id нет
+int scheduler_get_task(const Scheduler* scheduler, uint32_t id, SchedulerTaskInfo* info);
+// Имя задачи без копирования снимка. Указатель действителен до следующего вызова,
+// меняющего планировщик (add, remove, update, pop). NULL — задачи с таким id нет.
+const char* scheduler_task_name(const Scheduler* scheduler, uint32_t id);
+size_t scheduler_task_count(const Scheduler* scheduler);
+// Политика догона задачи; max_runs (> 0) учитывается только для SCHEDULER_CATCHUP_BOUNDED.
+// 0 — установлена, -1 — задачи нет или неверные аргументы.
+int scheduler_set_catchup(Scheduler* scheduler, uint32_t id, SchedulerCatchup policy, uint32_t max_runs);
+// Класс приоритета и оценка стоимости выполнения (в единицах вызывающего кода, по умолчанию 1).
+// Задача, которая уже ждёт в очереди готовых, переходит в новый класс со следующего срабатывания.
+// 0 — установлено, -1 — задачи нет или неверный класс.
+int scheduler_set_priority(Scheduler* scheduler, uint32_t id, SchedulerPriority priority, uint32_t cost);
+
+// Группы задач: произвольная метка (> 0), которой задачи помечает вызывающий код,
+// например все таймеры одного соединения. Массовые операции стоят O(размера группы),
+// а не O(всех задач). Задача уходит из группы, когда удаляется.
+// 0 — задача перенесена в группу (group = 0 — убрана из группы), -1 — задачи нет.
+int scheduler_set_group(Scheduler* scheduler, uint32_t id, uint32_t group);
+size_t scheduler_group_size(const Scheduler* scheduler, uint32_t group);
+// Функции ниже возвращают число затронутых задач. Одноразовая задача, которая уже сработала
+// и ждёт в очереди готовых, ими не затрагивается; периодическая остаётся в очереди готовых.
+// Удаляет все задачи группы.
+size_t scheduler_cancel_group(Scheduler* scheduler, uint32_t group);
+// Приостанавливает задачи группы: они не срабатывают, но и не удаляются.
+size_t scheduler_pause_group(Scheduler* scheduler, uint32_t group);
+// Возобновляет приостановленные задачи группы. Запуски периодических задач, наступившие
+// за время паузы, отбрасываются; просроченная одноразовая сработает на ближайшем update.
+size_t scheduler_resume_group(Scheduler* scheduler, uint32_t group);
+// Сдвигает следующий запуск задач группы на delta_ms (время не уходит ниже 0).
+size_t scheduler_shift_group(Scheduler* scheduler, uint32_t group, int64_t delta_ms);
+
+// Сообщает планировщику текущее время. Время не должно убывать:
+// меньшее, чем в прошлый раз, значение игнорируется. 32-битные часы переводятся
+// в 64-битное время через scheduler_time_extend.
+// Скачок любой длины стоит O(наступивших задач): пропущенные периоды считаются арифметически.
+void scheduler_update(Scheduler* scheduler, uint64_t now_ms);
+
+// Сон без опроса: время, до которого scheduler_update ничего не выдаст, — цикл может спать
+// до него, а не будить планировщик каждую миллисекунду. 0 — *deadline_ms заполнен
+// (если в очереди готовых есть задачи или какая-то уже просрочена — это время последнего
+// update, то есть работа есть сейчас). -1 — таймеров нет, спать можно до следующего
+// add (или resume_group); *deadline_ms = UINT64_MAX. Время ответа O(1), без прохода по задачам.
+// Это нижняя граница: колесо таймеров (движок по умолчанию) знает точное время, только если
+// задача ближе 64 мс (64 зёрен колеса при тике в мкс или нс), а иначе отвечает началом её
+// ячейки. Проснувшись к нему, update ничего не выдаст, а следующий запрос даст более точное
+// время — не больше нескольких (по числу уровней колеса) лишних пробуждений на задачу.
+// Куча и вектор отвечают точно.
+// В сборке SCHEDULER_MPSC неприменённые команды тоже считаются работой «сейчас»;
+// разбудить спящий цикл после add из другого потока — забота вызывающего кода.
+int scheduler_next_deadline(const Scheduler* scheduler, uint64_t* deadline_ms);
+
+// Очередь готовых задач: задача находится в ней не более одного раза.
+size_t scheduler_ready_count(const Scheduler* scheduler);
+// Число готовых задач класса priority.
+size_t scheduler_ready_count_priority(const Scheduler* scheduler, SchedulerPriority priority);
+// Извлекает до max_ids готовых задач: по классам приоритета, внутри класса —
+// в порядке (next_run_ms, порядок постановки).
+// Возвращает число записанных id.
+size_t scheduler_pop_ready(Scheduler* scheduler, uint32_t* ids, size_t max_ids);
+// То же, но заполняет массив снимков задач (имя, период, next_run_ms на момент извлечения;
+// у периодической задачи это уже следующий запуск). Снимок одноразовой задачи — единственный
+// способ узнать её имя: после извлечения она удалена. В *remaining (если не NULL) пишется
+// число задач, оставшихся в очереди: вызов повторяют, пока оно не станет 0.
+// Ни планировщик, ни вызывающий код при этом не выделяют память.
+size_t scheduler_pop_ready_tasks(Scheduler* scheduler, SchedulerTaskInfo* tasks, size_t max_tasks,
+                                 size_t* remaining);
+// Извлечение с бюджетом на такт: снимки выдаются в том же порядке, пока выдано меньше
+// max_tasks задач и их суммарная стоимость меньше max_cost (0 — стоимость не ограничена).
+// Последняя задача может бюджет превысить — дорогая задача не застревает в очереди;
+// задачи менее срочного класса при этом вперёд не пропускаются. В *spent (если не NULL) —
+// суммарная стоимость выданных.
+size_t scheduler_drain(Scheduler* scheduler, SchedulerTaskInfo* tasks, size_t max_tasks, uint64_t max_cost,
+                       uint64_t* spent);
+
+// Статистика выполнения. Планировщик задачи не выполняет и их длительности не знает:
+// вызывающий код сообщает её после выполнения. Длительность — в единицах вызывающего кода
+// (например, мкс), тех же, что оценка стоимости из scheduler_set_priority: превышением
+// считается длительность больше cost (по умолчанию 1, поэтому задайте cost в тех же единицах).
+// Статистика хранится у задачи, пока она существует; одноразовая задача удаляется при
+// извлечении, поэтому её выполнение не учитывается.
+// 0 — учтено, -1 — задачи с таким id нет.
+int scheduler_report_run(Scheduler* scheduler, uint32_t id, uint32_t duration);
+// 0 — stats заполнен, -1 — задачи с таким id нет.
+int scheduler_get_task_stats(const Scheduler* scheduler, uint32_t id, SchedulerTaskStats* stats);
+// До max_tasks самых медленных задач (по среднему, затем по максимуму), от самой медленной;
+// задачи без отчётов не учитываются. Проход по всей таблице, O(задач · log max_tasks) —
+// для периодического обзора, а не для каждого такта. Возвращает число записанных.
+size_t scheduler_slowest_tasks(const Scheduler* scheduler, SchedulerTaskStats* stats, size_t max_tasks);
+
+#ifdef SCHEDULER_TRACE
+// Трасса вызовов (-DSCHEDULER_TRACE=ON в CMake): каждый вызов, меняющий состояние, пишется
+// в бинарный файл, который потом воспроизводит scheduler_replay. Открывать сразу после
+// scheduler_create — для уже использованного планировщика вернётся -1.
+// В сборке SCHEDULER_MPSC команды других потоков пишутся, когда scheduler_update их применяет;
+// открывать трассу нужно до того, как другие потоки начнут вызывать планировщик.
+// Записи копятся в двойном буфере по 1024 записи; заполненную половину и начатую пишет в файл
+// scheduler_trace_flush — его стоит вызывать в простое, вне такта, хотя бы раз на 1024 записи.
+// Иначе такт, на котором заполнится и вторая половина, сам запишет первую (fwrite 56 КБ).
+// scheduler_destroy закрывает трассу сам.
+int scheduler_trace_open(Scheduler* scheduler, const char* path);
+void scheduler_trace_flush(Scheduler* scheduler);
+// 0 — трасса записана целиком, -1 — была ошибка записи.
+int scheduler_trace_close(Scheduler* scheduler);
+#endif
+
+#ifdef SCHEDULER_INLINE_GETTERS
+static inline size_t scheduler_task_count_inline(const Scheduler* scheduler) {
+    return scheduler ? ((const SchedulerCounters*)(const void*)scheduler)->task_count : 0;
+}
+static inline size_t scheduler_ready_count_inline(const Scheduler* scheduler) {
+    return scheduler ? ((const SchedulerCounters*)(const void*)scheduler)->ready_count : 0;
+}
+// (scheduler_task_count)(s) по-прежнему вызывает функцию из библиотеки.
+#define scheduler_task_count(scheduler) scheduler_task_count_inline(scheduler)
+#define scheduler_ready_count(scheduler) scheduler_ready_count_inline(scheduler)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCHEDULER_HPP
@@ -0,0 +1,371 @@
+// Бенчмарк движков планировщика на синтетической нагрузке: колесо таймеров,
+// 4-арная куча, отсортированный вектор.
+//
+// ./scheduler_bench [tasks] [ms] [wheel|heap|sorted|all] [сценарий|all]
+//
+// Сценарий задаёт смесь задач, распределение периодов и долю отмен:
+//
+// * доля периодических задач, остальные одноразовые (period_ms == 0);
+// * периоды (и задержки одноразовых задач) — равномерно 10..1000 мс или
+//   с тяжёлым хвостом (Парето, от 10 мс до часа, медиана ~18 мс);
+// * доля отмен — с какой вероятностью запланированный запуск (одноразовая задача
+//   или очередной период периодической) снимается раньше, чем наступит.
+//
+// Число задач постоянно: сработавшая одноразовая и отменённая задачи заменяются новыми
+// того же вида. Время идёт шагом 1 мс, на каждом такте: отмены, advance_to, извлечение
+// всех готовых пакетами по 256 снимков, запрос ближайшего срабатывания (как перед сном
+// в цикле без опроса). Каждый вызов меряется отдельно (add, remove, такт = advance_to,
+// выгрузка = все pop_ready такта, deadline = next_deadline), по замерам печатаются перцентили.
+// Память на задачу — живые байты кучи после заполнения плюс sizeof планировщика;
+// пик — максимум за время заполнения (рост векторов).
+//
+// Нагрузка задаётся в миллисекундах и переводится в тики сборки (SCHEDULER_TICK) без изменений,
+// так что сборки с разным тиком сравниваются на одной нагрузке; периоды длиннее 32-битного
+// числа тиков обрезаются.
+//
+// Нагрузка зависит только от зерна, поэтому у всех движков она одна и та же.
+// Отсортированный вектор стоит O(N) на вставку, поэтому при tasks > 50000 он
+// запускается, только если указан явно.
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <vector>
+
+#include "scheduler_impl.hpp"
+
+// Учёт памяти: глобальные operator new/delete хранят размер блока перед ним.
+namespace {
+
+const size_t kHeader = alignof(std::max_align_t);
+size_t g_live_bytes = 0;
+size_t g_peak_bytes = 0;
+
+} // namespace
+
+void* operator new(size_t n) {
+    unsigned char* p = static_cast<unsigned char*>(std::malloc(n + kHeader));
+    if (!p) throw std::bad_alloc();
+    std::memcpy(p, &n, sizeof(n));
+    g_live_bytes += n;
+    if (g_live_bytes > g_peak_bytes) g_peak_bytes = g_live_bytes;
+    return p + kHeader;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    unsigned char* p = static_cast<unsigned char*>(ptr) - kHeader;
+    size_t n;
+    std::memcpy(&n, p, sizeof(n));
+    g_live_bytes -= n;
+    std::free(p);
+}
+
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+
+namespace {
+
+const uint32_t kSortedMaxTasks = 50000;
+const size_t kBatch = 256;
+const uint64_t kTicksPerMs = SCHEDULER_TICKS_PER_SECOND / 1000;
+
+uint32_t ms_to_ticks(uint32_t ms) { return uint32_t(std::min<uint64_t>(ms * kTicksPerMs, UINT32_MAX)); }
+
+typedef std::chrono::steady_clock Clock;
+
+uint64_t ns_between(Clock::time_point a, Clock::time_point b) {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count());
+}
+
+// Лог-линейная гистограмма задержек в нс: 8 корзин на каждую степень двойки (точность ~12%),
+// поэтому 10^7 замеров не требуют 10^7 чисел в памяти.
+class Histogram {
+public:
+    Histogram() : counts_(kBuckets, 0) {}
+
+    void add(uint64_t ns) {
+        counts_[bucket(ns)]++;
+        total_++;
+        sum_ += ns;
+        if (ns > max_) max_ = ns;
+    }
+
+    uint64_t count() const { return total_; }
+    uint64_t max() const { return max_; }
+    uint64_t sum() const { return sum_; }
+
+    // Середина корзины, в которой лежит p-й перцентиль (ранг ceil(p * n)).
+    double percentile(double p) const {
+        if (total_ == 0) return 0;
+        const uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(p * double(total_))));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; i++) {
+            seen += counts_[i];
+            if (seen >= rank) return std::min(double(max_), (double(lower(i)) + double(lower(i + 1))) / 2);
+        }
+        return double(max_);
+    }
+
+private:
+    static const size_t kSub = 8;
+    static const size_t kBuckets = 2 * kSub + (64 - 4) * kSub;
+
+    // Значения до 16 — каждое в своей корзине, дальше 8 корзин на октаву.
+    static size_t bucket(uint64_t v) {
+        if (v < 2 * kSub) return size_t(v);
+        int msb = 63;
+        while (!(v >> msb)) msb--;
+        return 2 * kSub + size_t(msb - 4) * kSub + size_t((v >> (msb - 3)) & (kSub - 1));
+    }
+
+    static uint64_t lower(size_t i) {
+        if (i <= 2 * kSub) return i;
+        const size_t octave = (i - 2 * kSub) / kSub + 4;
+        const size_t sub = (i - 2 * kSub) % kSub;
+        return (uint64_t(kSub + sub)) << (octave - 3);
+    }
+
+    std::vector<uint64_t> counts_;
+    uint64_t total_ = 0;
+    uint64_t sum_ = 0;
+    uint64_t max_ = 0;
+};
+
+enum Periods { kUniform, kPareto };
+
+struct Scenario {
+    const char* name;
+    double periodic_share;
+    Periods periods;
+    double cancel_rate;
+};
+
+const Scenario kScenarios[] = {
+    {"periodic", 1.0, kUniform, 0.0},
+    {"periodic-pareto", 1.0, kPareto, 0.0},
+    {"mixed", 0.5, kUniform, 0.1},
+    {"mixed-pareto", 0.5, kPareto, 0.1},
+    {"oneshot", 0.0, kUniform, 0.0},
+    {"oneshot-cancel", 0.0, kUniform, 0.5},
+    {"oneshot-pareto-cancel", 0.0, kPareto, 0.5},
+};
+
+// Генератор нагрузки: все решения — из одного потока случайных чисел.
+class Workload {
+public:
+    explicit Workload(const Scenario& sc) : sc_(sc), rng_(42) {}
+
+    bool periodic() { return unit() < sc_.periodic_share; }
+    bool cancel() { return sc_.cancel_rate > 0 && unit() < sc_.cancel_rate; }
+
+    uint32_t period() {
+        if (sc_.periods == kUniform) return 10 + uint32_t(rng_() % 991);
+        // Парето с xm = 10 мс, alpha = 1.2, обрезанное часом.
+        const double u = 1.0 - unit();
+        const double p = 10.0 / std::pow(u, 1.0 / 1.2);
+        return p < 3600000.0 ? uint32_t(p) : 3600000u;
+    }
+
+    // Равномерно в [lo, hi].
+    uint64_t between(uint64_t lo, uint64_t hi) { return lo + rng_() % (hi - lo + 1); }
+
+private:
+    double unit() { return double(rng_() >> 11) * (1.0 / 9007199254740992.0); }
+
+    const Scenario& sc_;
+    std::mt19937_64 rng_;
+};
+
+struct Cancel {
+    uint64_t at;
+    uint32_t id;
+    bool periodic;
+
+    // Для min-кучи по времени отмены (std::push_heap строит max-кучу).
+    bool operator<(const Cancel& o) const { return at > o.at; }
+};
+
+struct Result {
+    Histogram add, remove, tick, drain, deadline;
+    size_t live_bytes = 0;
+    size_t peak_bytes = 0;
+    uint64_t fired = 0;
+    uint64_t cancelled = 0;
+    uint64_t failures = 0;      // add вернул 0 или remove не нашёл задачу
+};
+
+template <class Impl>
+class Driver {
+public:
+    Driver(const Scenario& sc, uint32_t tasks, Result& r) : w_(sc), r_(r) { cancels_.reserve(tasks); }
+
+    void run(uint32_t tasks, uint64_t ms) {
+        // Память драйвера выделена заранее, поэтому всё, что прибавится, — память планировщика.
+        const size_t base = g_live_bytes;
+        g_peak_bytes = base;
+        {
+            Impl s;
+            for (uint32_t i = 0; i < tasks; i++) add(s, 0, w_.periodic());
+            r_.live_bytes = g_live_bytes - base + sizeof(Impl);
+            r_.peak_bytes = g_peak_bytes - base + sizeof(Impl);
+
+            SchedulerTaskInfo batch[kBatch];
+            for (uint64_t now = 1; now <= ms; now++) {
+                while (!cancels_.empty() && cancels_.front().at <= now) {
+                    const Cancel c = cancels_.front();
+                    std::pop_heap(cancels_.begin(), cancels_.end());
+                    cancels_.pop_back();
+                    remove(s, c.id);
+                    add(s, now, c.periodic);
+                }
+
+                Clock::time_point t0 = Clock::now();
+                s.advance_to(now * kTicksPerMs);
+                Clock::time_point t1 = Clock::now();
+                r_.tick.add(ns_between(t0, t1));
+
+                uint64_t drain_ns = 0;
+                for (;;) {
+                    t0 = Clock::now();
+                    const size_t n = s.pop_ready(batch, kBatch);
+                    t1 = Clock::now();
+                    drain_ns += ns_between(t0, t1);
+                    if (n == 0) break;
+                    r_.fired += n;
+                    for (size_t k = 0; k < n; k++) {
+                        if (batch[k].period_ms == 0) add(s, now, false);
+                        else plan_cancel(batch[k].id, true, now, batch[k].next_run_ms / kTicksPerMs);
+                    }
+                }
+                r_.drain.add(drain_ns);
+
+                uint64_t deadline = 0;
+                t0 = Clock::now();
+                s.next_deadline(deadline);
+                t1 = Clock::now();
+                r_.deadline.add(ns_between(t0, t1));
+            }
+        }
+    }
+
+private:
+    void add(Impl& s, uint64_t now, bool periodic) {
+        uint64_t first;
+        uint32_t period = w_.period();
+        if (periodic) {
+            first = now + 1 + w_.between(0, period - 1);    // случайная фаза
+        } else {
+            first = now + period;
+            period = 0;
+        }
+        const Clock::time_point t0 = Clock::now();
+        const uint32_t id = s.add_task("job", ms_to_ticks(period), first * kTicksPerMs);
+        const Clock::time_point t1 = Clock::now();
+        r_.add.add(ns_between(t0, t1));
+        if (id == 0) {
+            r_.failures++;
+            return;
+        }
+        plan_cancel(id, periodic, now, first);
+    }
+
+    // Отмена наступает строго между текущим тактом и запуском, поэтому задача ещё в очереди таймеров.
+    void plan_cancel(uint32_t id, bool periodic, uint64_t now, uint64_t run_at) {
+        if (run_at < now + 2 || !w_.cancel()) return;
+        Cancel c;
+        c.at = w_.between(now + 1, run_at - 1);
+        c.id = id;
+        c.periodic = periodic;
+        cancels_.push_back(c);
+        std::push_heap(cancels_.begin(), cancels_.end());
+    }
+
+    void remove(Impl& s, uint32_t id) {
+        const Clock::time_point t0 = Clock::now();
+        const bool ok = s.remove_task(id);
+        const Clock::time_point t1 = Clock::now();
+        r_.remove.add(ns_between(t0, t1));
+        if (ok) r_.cancelled++;
+        else r_.failures++;
+    }
+
+    Workload w_;
+    Result& r_;
+    std::vector<Cancel> cancels_;
+};
+
+void print_latency(const char* what, const Histogram& h) {
+    std::printf("    %-8s %11llu  p50 %7.0f  p90 %7.0f  p99 %8.0f  p99.9 %8.0f  max %9llu ns  total %8.1f ms\n",
+                what, (unsigned long long)h.count(), h.percentile(0.5), h.percentile(0.9), h.percentile(0.99),
+                h.percentile(0.999), (unsigned long long)h.max(), double(h.sum()) / 1e6);
+}
+
+template <template <class> class Engine>
+void bench(const char* engine, const Scenario& sc, uint32_t tasks, uint64_t ms) {
+    Result r;
+    {
+        Driver<BasicScheduler<Engine>> d(sc, tasks, r);
+        d.run(tasks, ms);
+    }
+    std::printf("  %-7s %7.1f B/task (peak %.1f)  fired %llu  cancelled %llu\n", engine,
+                double(r.live_bytes) / tasks, double(r.peak_bytes) / tasks, (unsigned long long)r.fired,
+                (unsigned long long)r.cancelled);
+    print_latency("add", r.add);
+    print_latency("remove", r.remove);
+    print_latency("tick", r.tick);
+    print_latency("drain", r.drain);
+    print_latency("deadline", r.deadline);
+    if (r.failures > 0) std::printf("    %llu calls failed\n", (unsigned long long)r.failures);
+}
+
+// Пустой замер: сколько из каждого числа выше приходится на сами часы.
+double clock_overhead() {
+    Histogram h;
+    for (int i = 0; i < 100000; i++) {
+        const Clock::time_point t0 = Clock::now();
+        const Clock::time_point t1 = Clock::now();
+        h.add(ns_between(t0, t1));
+    }
+    return h.percentile(0.5);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const uint32_t tasks = argc > 1 ? uint32_t(std::strtoul(argv[1], nullptr, 10)) : 100000;
+    const uint64_t ms = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1000;
+    const char* engine = argc > 3 ? argv[3] : "all";
+    const char* scenario = argc > 4 ? argv[4] : "all";
+    if (tasks == 0) {
+        std::fprintf(stderr, "usage: %s [tasks] [ms] [wheel|heap|sorted|all] [scenario|all]\n", argv[0]);
+        return 2;
+    }
+    std::printf("tasks = %u, ms = %llu, clock overhead ~%.0f ns per sample\n", tasks, (unsigned long long)ms,
+                clock_overhead());
+
+    const bool all_engines = std::strcmp(engine, "all") == 0;
+    bool found = false;
+    for (const Scenario& sc : kScenarios) {
+        if (std::strcmp(scenario, "all") != 0 && std::strcmp(scenario, sc.name) != 0) continue;
+        found = true;
+        std::printf("\n%s: %.0f%% periodic, %s periods, %.0f%% cancelled\n", sc.name, sc.periodic_share * 100,
+                    sc.periods == kUniform ? "uniform" : "pareto", sc.cancel_rate * 100);
+        if (all_engines || std::strcmp(engine, "wheel") == 0) bench<TimingWheel>("wheel", sc, tasks, ms);
+        if (all_engines || std::strcmp(engine, "heap") == 0) bench<TaskHeap>("heap", sc, tasks, ms);
+        if (std::strcmp(engine, "sorted") == 0 || (all_engines && tasks <= kSortedMaxTasks)) {
+            bench<SortedQueue>("sorted", sc, tasks, ms);
+        } else if (all_engines) {
+            std::printf("  sorted  skipped: tasks > %u\n", kSortedMaxTasks);
+        }
+    }
+    if (!found) {
+        std::fprintf(stderr, "unknown scenario: %s\n", scenario);
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+#include <stdio.h>
+#include "scheduler.hpp"
+
+// Пример: периодический опрос датчиков и одноразовая калибровка.
+// Время "идёт" в цикле с шагом 50 мс, задачи выполняет сам вызывающий код.
+// Времена переводятся в тики сборки (SCHEDULER_TICK), вывод — в миллисекундах.
+int main(int argc, char** argv) {
+    const uint64_t ms = SCHEDULER_TICKS_PER_SECOND / 1000;
+    Scheduler* s = scheduler_create();
+#ifdef SCHEDULER_TRACE
+    // ./scheduler_demo demo.strace — записать трассу для scheduler_replay.
+    if (argc > 1 && scheduler_trace_open(s, argv[1]) != 0) printf("cannot write trace %s\n", argv[1]);
+#else
+    (void)argc;
+    (void)argv;
+#endif
+
+    scheduler_add_task(s, "poll_temperature", 100 * ms, 100 * ms);
+    scheduler_add_task(s, "poll_pressure", 250 * ms, 0);
+    scheduler_add_task(s, "calibrate", 0, 300 * ms);
+    // Счётчик с периодом 10 мс при шаге цикла 50 мс: пропущенные запуски не теряются,
+    // а приходят одним элементом с runs = 5.
+    uint32_t heartbeat = scheduler_add_task(s, "heartbeat", 10 * ms, 10 * ms);
+    scheduler_set_catchup(s, heartbeat, SCHEDULER_CATCHUP_COALESCE, 0);
+    printf("Tasks = %zu\n", scheduler_task_count(s));
+
+    // Буфер снимков на стеке: на каждом шаге цикла память не выделяется.
+    SchedulerTaskInfo ready[2];
+    for (uint64_t now = 0; now <= 500; now += 50) {
+        scheduler_update(s, now * ms);
+
+        size_t remaining;
+        do {
+            size_t n = scheduler_pop_ready_tasks(s, ready, sizeof(ready) / sizeof(ready[0]), &remaining);
+            for (size_t i = 0; i < n; i++) {
+                if (ready[i].period_ms > 0) {
+                    printf("[%3llu ms] run %s x%u (next at %llu ms)\n", (unsigned long long)now, ready[i].name,
+                           (unsigned)ready[i].runs, (unsigned long long)(ready[i].next_run_ms / ms));
+                } else {
+                    printf("[%3llu ms] run one-shot %s\n", (unsigned long long)now, ready[i].name);
+                }
+            }
+        } while (remaining > 0);
+    }
+
+    printf("Tasks = %zu\n", scheduler_task_count(s));
+    scheduler_destroy(s);
+    return 0;
+}
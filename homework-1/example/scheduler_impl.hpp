@@ -0,0 +1,561 @@
+#ifndef SCHEDULER_IMPL_HPP
+#define SCHEDULER_IMPL_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "group_table.hpp"
+#include "name_table.hpp"
+#include "ready_ring.hpp"
+#include "scheduler.hpp"
+#include "sorted_queue.hpp"
+#include "storage.hpp"
+#include "task_heap.hpp"
+#include "task_stats.hpp"
+#include "timing_wheel.hpp"
+
+// Внутренняя C++-реализация планировщика, наружу видна только через scheduler.hpp.
+//
+// Engine — очередь таймеров (TimingWheel, TaskHeap или SortedQueue), она хранит только
+// слоты и читает времена из таблицы задач. Для C-библиотеки движок выбирается при сборке
+// (SCHEDULER_ENGINE в CMake), бенчмарк инстанцирует все три.
+//
+// Задачи лежат в плотной таблице слотов; id = (поколение << 24) | слот,
+// поэтому поиск по id — O(1), а id удалённой задачи не совпадёт с id новой в том же слоте
+// (пока поколение не сделает круг из 255 значений).
+// Таблица разделена на горячую часть (времена, период, состояние — 32 байта, две задачи
+// на кэш-линию), которую трогают такт и движки, и холодную: индекс интернированного имени
+// и оценка стоимости в отдельном массиве. Они читаются только по запросу — get_task, task_name,
+// pop со снимками, drain.
+// Там же ссылки групп (GroupTable): массовые операции над группой стоят O(её размера),
+// и статистика выполнения, которую сообщает вызывающий код (TaskStats).
+// Готовые задачи стоят в кольцах по классам приоритета; pop опустошает их от самого срочного.
+// Память выделяется только при добавлении задач и первой смене класса; advance_to() и pop_ready()
+// не аллоцируют.
+//
+// Пропущенные запуски периодической задачи считаются арифметически, а не перебором периодов:
+// при скачке времени задача срабатывает один раз, её next_run_ms сразу переносится за now,
+// а число накопившихся запусков (runs) ограничивается её политикой догона.
+// В сборке SCHEDULER_STATIC вся память — один блок на max_tasks задач, выделенный заранее.
+template <template <class> class Engine>
+class BasicScheduler {
+public:
+    BasicScheduler() : timers_(tasks_) {}
+
+#ifdef SCHEDULER_STATIC
+    // Память массивов, которую конструктор возьмёт из арены (сам объект — отдельно).
+    static constexpr size_t storage_bytes(uint32_t max_tasks) {
+        return Arena::bytes<Task>(max_tasks) + Arena::bytes<uint32_t>(max_tasks) + Arena::bytes<Cold>(max_tasks) +
+               kLanes * ReadyRing::storage_bytes(max_tasks) + NameTable::storage_bytes(max_tasks) + GroupTable::storage_bytes(max_tasks) +
+               TaskStats::storage_bytes(max_tasks) + Engine<Array<Task>>::storage_bytes(max_tasks);
+    }
+
+    BasicScheduler(Arena& arena, uint32_t max_tasks) : timers_(tasks_), limit_(max_tasks) {
+        tasks_.attach(arena.take<Task>(max_tasks), max_tasks);
+        free_.attach(arena.take<uint32_t>(max_tasks), max_tasks);
+        for (ReadyRing& ring : ready_) ring.attach(arena, max_tasks);
+        cold_.attach(arena.take<Cold>(max_tasks), max_tasks);
+        name_table_.attach(arena, max_tasks);
+        groups_.attach(arena, max_tasks);
+        stats_.attach(arena, max_tasks);
+        timers_.attach(arena, max_tasks);
+    }
+#endif
+
+    uint32_t add_task(const char* name, uint32_t period_ms, uint64_t next_run_ms) {
+        const uint32_t id = reserve();
+        if (id != 0) activate(id, name, period_ms, next_run_ms);
+        return id;
+    }
+
+    // Добавление в два шага: reserve() выдаёт id заранее (для очереди команд от других потоков),
+    // activate() превращает зарезервированный слот в задачу. 0 — таблица заполнена.
+    uint32_t reserve() {
+        uint32_t slot;
+        if (!free_.empty()) {
+            slot = free_.back();
+            free_.pop_back();
+        } else {
+            if (tasks_.size() >= limit_) return 0;
+            slot = uint32_t(tasks_.size());
+            grow(slot + 1);
+        }
+        Task& t = tasks_[slot];
+        t.state = kReserved;
+        return make_id(slot, t.generation);
+    }
+
+    bool activate(uint32_t id, const char* name, uint32_t period_ms, uint64_t next_run_ms) {
+        const uint32_t slot = find(id, kReserved);
+        if (slot == kNoSlot) return false;
+        cold_[slot].name = name_table_.intern(name);
+        cold_[slot].cost = 1;
+        stats_.reset(slot);
+        Task& t = tasks_[slot];
+        t.state = kActive;
+        t.pending = false;
+        t.catchup = SCHEDULER_CATCHUP_SKIP;
+        t.priority = SCHEDULER_PRIORITY_NORMAL;
+        t.max_runs = 1;
+        t.runs = 0;
+        t.period_ms = period_ms;
+        t.next_run_ms = next_run_ms;
+        t.seq = next_seq_++;
+        timers_.insert(slot);
+        active_++;
+        return true;
+    }
+
+    bool remove_task(uint32_t id) {
+        const uint32_t slot = find(id);
+        if (slot == kNoSlot) return false;
+        Task& t = tasks_[slot];
+        if (t.state == kActive) timers_.erase(slot);
+        active_--;
+        drop(slot);
+        return true;
+    }
+
+    bool get_task(uint32_t id, SchedulerTaskInfo& info) const {
+        const uint32_t slot = find(id);
+        if (slot == kNoSlot) return false;
+        snapshot(info, id, slot);
+        return true;
+    }
+
+    // Имя задачи; указатель действителен до следующего add_task. nullptr — задачи нет.
+    const char* task_name(uint32_t id) const {
+        const uint32_t slot = find(id);
+        return slot == kNoSlot ? nullptr : name_table_.get(cold_[slot].name);
+    }
+
+    bool set_catchup(uint32_t id, SchedulerCatchup policy, uint32_t max_runs) {
+        const uint32_t slot = find(id);
+        if (slot == kNoSlot) return false;
+        Task& t = tasks_[slot];
+        switch (policy) {
+        case SCHEDULER_CATCHUP_SKIP: t.max_runs = 1; break;
+        case SCHEDULER_CATCHUP_COALESCE: t.max_runs = 0xFFFFFFFFu; break;
+        case SCHEDULER_CATCHUP_BOUNDED:
+            if (max_runs == 0) return false;
+            t.max_runs = max_runs;
+            break;
+        default: return false;
+        }
+        t.catchup = uint8_t(policy);
+        return true;
+    }
+
+    bool set_priority(uint32_t id, SchedulerPriority priority, uint32_t cost) {
+        const uint32_t slot = find(id);
+        if (slot == kNoSlot || uint32_t(priority) >= kLanes) return false;
+        use_lane(priority);
+        tasks_[slot].priority = uint8_t(priority);
+        cold_[slot].cost = cost;
+        return true;
+    }
+
+    // Отчёт о выполнении: длительность в единицах вызывающего кода, тех же, что у cost.
+    bool report_run(uint32_t id, uint32_t duration) {
+        const uint32_t slot = find(id);
+        if (slot == kNoSlot) return false;
+        stats_.record(slot, duration, cold_[slot].cost);
+        return true;
+    }
+
+    bool task_stats(uint32_t id, SchedulerTaskStats& info) const {
+        const uint32_t slot = find(id);
+        if (slot == kNoSlot) return false;
+        stats_snapshot(info, id, slot);
+        return true;
+    }
+
+    // До max самых медленных задач с отчётами, от самой медленной: по среднему, затем
+    // по максимуму. Один проход по слотам с кучей из max элементов прямо в out —
+    // O(слотов · log max), без выделения памяти.
+    size_t slowest(SchedulerTaskStats* out, size_t max) const {
+        size_t n = 0;
+        if (max == 0) return 0;
+        for (uint32_t slot = 0; slot < tasks_.size(); slot++) {
+            if (!live(tasks_[slot].state) || stats_.get(slot).reports == 0) continue;
+            SchedulerTaskStats s;
+            stats_snapshot(s, make_id(slot, tasks_[slot].generation), slot);
+            if (n < max) {
+                out[n++] = s;
+                std::push_heap(out, out + n, slower);
+            } else if (slower(s, out[0])) {
+                // Вершина кучи — самая быстрая из отобранных.
+                std::pop_heap(out, out + n, slower);
+                out[n - 1] = s;
+                std::push_heap(out, out + n, slower);
+            }
+        }
+        std::sort_heap(out, out + n, slower);
+        return n;
+    }
+
+    // Группы: метка вызывающего кода, 0 — без группы. Одноразовая задача, которая уже
+    // сработала и ждёт извлечения, остаётся в группе, но массовые операции её не трогают.
+    bool set_group(uint32_t id, uint32_t group) {
+        const uint32_t slot = find(id);
+        if (slot == kNoSlot) return false;
+        groups_.join(slot, group);
+        return true;
+    }
+
+    size_t group_size(uint32_t group) const { return groups_.size(group); }
+
+    // Удаляет задачи группы; возвращает их число.
+    size_t cancel_group(uint32_t group) {
+        timers_.erase_many(groups_.size(group), Members(*this, group, kActive));
+        size_t n = 0;
+        groups_.for_each(group, [this, &n](uint32_t slot) {
+            if (!live(tasks_[slot].state)) return;
+            n++;
+            active_--;
+            drop(slot);
+        });
+        return n;
+    }
+
+    // Снимает задачи группы с очереди таймеров; время следующего запуска сохраняется.
+    // Уже стоящие в очереди готовых задачи из неё не убираются.
+    size_t pause_group(uint32_t group) {
+        timers_.erase_many(groups_.size(group), Members(*this, group, kActive));
+        size_t n = 0;
+        groups_.for_each(group, [this, &n](uint32_t slot) {
+            if (tasks_[slot].state != kActive) return;
+            tasks_[slot].state = kPaused;
+            n++;
+        });
+        return n;
+    }
+
+    // Возвращает приостановленные задачи группы. Запуски периодической задачи, наступившие
+    // за время паузы, пропускаются: следующий — первый после текущего времени.
+    // Просроченная одноразовая задача сработает на ближайшем advance_to.
+    size_t resume_group(uint32_t group) {
+        const uint64_t now = timers_.now();
+        groups_.for_each(group, [this, now](uint32_t slot) {
+            Task& t = tasks_[slot];
+            if (t.state != kPaused || t.period_ms == 0 || t.next_run_ms > now) return;
+            t.next_run_ms += ((now - t.next_run_ms) / t.period_ms + 1) * t.period_ms;
+        });
+        timers_.insert_many(groups_.size(group), Members(*this, group, kPaused));
+        size_t n = 0;
+        groups_.for_each(group, [this, &n](uint32_t slot) {
+            if (tasks_[slot].state != kPaused) return;
+            tasks_[slot].state = kActive;
+            n++;
+        });
+        return n;
+    }
+
+    // Сдвигает следующий запуск задач группы (и приостановленных тоже) на delta_ms;
+    // время не уходит ниже 0. Задача, сдвинутая в прошлое, сработает на ближайшем advance_to.
+    size_t shift_group(uint32_t group, int64_t delta_ms) {
+        const size_t members = groups_.size(group);
+        timers_.erase_many(members, Members(*this, group, kActive));
+        size_t n = 0;
+        groups_.for_each(group, [this, delta_ms, &n](uint32_t slot) {
+            Task& t = tasks_[slot];
+            if (!live(t.state)) return;
+            if (delta_ms < 0 && t.next_run_ms < uint64_t(-delta_ms)) t.next_run_ms = 0;
+            else t.next_run_ms += uint64_t(delta_ms);
+            n++;
+        });
+        timers_.insert_many(members, Members(*this, group, kActive));
+        return n;
+    }
+
+    size_t task_count() const { return active_; }
+
+    // Число слотов, когда-либо занятых задачами: 0 — планировщик ещё не использовался.
+    size_t slot_count() const { return tasks_.size(); }
+
+    // Продвигает время до now_ms. Каждая наступившая задача обрабатывается один раз
+    // независимо от длины скачка, поэтому час симуляции за один вызов стоит O(задач).
+    void advance_to(uint64_t now_ms) {
+        if (now_ms < timers_.now()) return;
+        target_ms_ = now_ms;
+        timers_.advance(now_ms, [this](uint32_t slot) { fire(slot); });
+    }
+
+    size_t ready_count() const { return ready_size_; }
+
+    size_t ready_count(SchedulerPriority priority) const {
+        return uint32_t(priority) < kLanes ? ready_[priority].size() : 0;
+    }
+
+    // Время последнего advance_to.
+    uint64_t now() const { return timers_.now(); }
+
+    // Время, раньше которого advance_to ничего не выдаст (не меньше текущего); если очередь
+    // готовых не пуста — текущее время. Куча и вектор дают ближайший next_run_ms, колесо —
+    // нижнюю границу (см. TimingWheel::next_due). false — таймеров нет: работа появится
+    // только с новой задачей или возобновлением группы.
+    bool next_deadline(uint64_t& deadline_ms) const {
+        const uint64_t now = timers_.now();
+        if (ready_size_ > 0) {
+            deadline_ms = now;
+            return true;
+        }
+        const uint64_t due = timers_.next_due();
+        if (due == Engine<Array<Task>>::kNever) return false;
+        deadline_ms = due > now ? due : now;
+        return true;
+    }
+
+    size_t pop_ready(uint32_t* ids, size_t max_ids) {
+        uint64_t spent = 0;
+        return pop<false, false>(max_ids, 0, spent, [ids](size_t i, uint32_t id, uint32_t) { ids[i] = id; });
+    }
+
+    // То же, но сразу со снимком задачи: одноразовая задача после извлечения удаляется,
+    // и get_task её уже не найдёт.
+    size_t pop_ready(SchedulerTaskInfo* tasks, size_t max_tasks) {
+        uint64_t spent = 0;
+        return pop<true, false>(max_tasks, 0, spent,
+                                [this, tasks](size_t i, uint32_t id, uint32_t slot) { snapshot(tasks[i], id, slot); });
+    }
+
+    // То же с бюджетом: задачи выдаются, пока их суммарная стоимость (spent) меньше max_cost,
+    // последняя может его превысить.
+    size_t drain(SchedulerTaskInfo* tasks, size_t max_tasks, uint64_t max_cost, uint64_t& spent) {
+        spent = 0;
+        return pop<true, true>(max_tasks, max_cost, spent,
+                               [this, tasks](size_t i, uint32_t id, uint32_t slot) { snapshot(tasks[i], id, slot); });
+    }
+
+private:
+    static const uint32_t kSlotBits = 24;
+    static const uint32_t kMaxSlots = 1u << kSlotBits;
+    static const uint32_t kNoSlot = 0xFFFFFFFFu;
+    static const size_t kPrefetch = 8;
+    static const uint32_t kLanes = SCHEDULER_PRIORITY_COUNT;
+
+    enum State : uint8_t {
+        kFree,
+        kActive,    // в колесе
+        kFired,     // одноразовая, сработала и ждёт извлечения
+        kRemoved,   // удалена, пока ждала в очереди готовых
+        kReserved,  // id выдан, задача ещё не добавлена
+        kPaused,    // приостановлена вместе с группой: не в колесе, но не удалена
+        kLive,      // только для find: kActive или kPaused
+    };
+
+    static bool live(uint8_t state) { return state == kActive || state == kPaused; }
+
+    // Задачи группы в состоянии state, в виде, который принимают insert_many/erase_many движков.
+    class Members {
+    public:
+        Members(const BasicScheduler& s, uint32_t group, uint8_t state) : s_(s), group_(group), state_(state) {}
+
+        template <class F>
+        void operator()(F f) const {
+            const Array<Task>& tasks = s_.tasks_;
+            const uint8_t state = state_;
+            s_.groups_.for_each(group_, [&tasks, state, &f](uint32_t slot) {
+                if (tasks[slot].state == state) f(slot);
+            });
+        }
+
+    private:
+        const BasicScheduler& s_;
+        uint32_t group_;
+        uint8_t state_;
+    };
+
+    struct Task {
+        uint64_t next_run_ms = 0;
+        uint64_t seq = 0;           // порядок постановки: разрешает равенство next_run_ms
+        uint32_t period_ms = 0;
+        uint32_t runs = 0;          // накопленные запуски, пока задача в очереди готовых
+        uint32_t max_runs = 1;      // предел runs по политике догона
+        uint8_t catchup : 4;        // SchedulerCatchup; оба поля задаёт activate
+        uint8_t priority : 4;       // SchedulerPriority: в какое кольцо готовых встаёт задача
+        uint8_t generation = 1;
+        uint8_t state = kFree;
+        bool pending = false;       // стоит в очереди готовых
+    };
+
+    struct Cold {
+        uint32_t name = 0;          // индекс имени в name_table_
+        uint32_t cost = 1;          // оценка стоимости выполнения для drain
+    };
+
+    static uint32_t make_id(uint32_t slot, uint8_t generation) {
+        return (uint32_t(generation) << kSlotBits) | slot;
+    }
+
+    void snapshot(SchedulerTaskInfo& info, uint32_t id, uint32_t slot) const {
+        const Task& t = tasks_[slot];
+        info.id = id;
+        info.period_ms = t.period_ms;
+        info.next_run_ms = t.next_run_ms;
+        info.runs = t.runs;
+        info.catchup = t.catchup;
+        info.priority = t.priority;
+        info.cost = cold_[slot].cost;
+        info.group = groups_.tag(slot);
+        info.paused = t.state == kPaused;
+        std::memcpy(info.name, name_table_.get(cold_[slot].name), sizeof(info.name));
+    }
+
+    void stats_snapshot(SchedulerTaskStats& info, uint32_t id, uint32_t slot) const {
+        const TaskStats::Entry& e = stats_.get(slot);
+        info.id = id;
+        info.reports = e.reports;
+        info.mean = uint32_t(std::min(double(e.mean) + 0.5, double(UINT32_MAX)));
+        info.max = e.max;
+        info.overruns = e.overruns;
+    }
+
+    static bool slower(const SchedulerTaskStats& a, const SchedulerTaskStats& b) {
+        if (a.mean != b.mean) return a.mean > b.mean;
+        if (a.max != b.max) return a.max > b.max;
+        return a.id < b.id;
+    }
+
+    // Извлекает до max готовых задач, кольца — от самого срочного класса, для каждой
+    // вызывает out(индекс, id, слот). С Budget останавливается, как только spent (сумма
+    // стоимостей выданных) достигла max_cost. Слоты в очереди идут вразброс, поэтому задача
+    // (и холодные поля, если они нужны) запрашивается в кэш на kPrefetch элементов вперёд.
+    template <bool Cold, bool Budget, class Out>
+    size_t pop(size_t max, uint64_t max_cost, uint64_t& spent, Out out) {
+        size_t n = 0;
+        for (uint32_t lane = 0; lane < kLanes; lane++) {
+            ReadyRing& ring = ready_[lane];
+            while (n < max && !ring.empty()) {
+                if (Budget && spent >= max_cost) return n;
+                if (ring.size() > kPrefetch) {
+                    const uint32_t ahead = ring.peek(kPrefetch);
+                    __builtin_prefetch(&tasks_[ahead], 1);
+                    if (Cold) __builtin_prefetch(&cold_[ahead]);
+                }
+                const uint32_t slot = ring.pop();
+                ready_size_--;
+                Task& t = tasks_[slot];
+                t.pending = false;
+                if (t.state == kRemoved) {
+                    release(slot);
+                    continue;
+                }
+                if (Budget) spent += cold_[slot].cost;
+                out(n++, make_id(slot, t.generation), slot);
+                t.runs = 0;
+                // Одноразовая задача удаляется после выдачи на выполнение.
+                if (t.state == kFired) release(slot);
+            }
+        }
+        return n;
+    }
+
+    // По умолчанию ищется живая задача (kActive или kPaused).
+    uint32_t find(uint32_t id, uint8_t state = kLive) const {
+        const uint32_t slot = id & (kMaxSlots - 1);
+        if (slot >= tasks_.size()) return kNoSlot;
+        const Task& t = tasks_[slot];
+        if (t.generation != (id >> kSlotBits)) return kNoSlot;
+        if (state == kLive ? !live(t.state) : t.state != state) return kNoSlot;
+        return slot;
+    }
+
+    // Удаление уже снятой с таймеров задачи. Если она ждёт в очереди готовых,
+    // слот освободится при извлечении.
+    void drop(uint32_t slot) {
+        if (tasks_[slot].pending) {
+            tasks_[slot].state = kRemoved;
+            groups_.leave(slot);
+        } else {
+            release(slot);
+        }
+    }
+
+    void release(uint32_t slot) {
+        Task& t = tasks_[slot];
+        t.state = kFree;
+        groups_.leave(slot);
+        name_table_.release(cold_[slot].name);
+        cold_[slot].name = 0;
+        t.generation = t.generation == 255 ? 1 : uint8_t(t.generation + 1);
+        free_.push_back(slot);
+    }
+
+    // Рост таблицы: остальные массивы резервируются по ёмкости таблицы, а не по числу слотов,
+    // иначе reserve(n) каждого добавления заново выделял бы и копировал их целиком.
+    // Растут кольца готовых только тех классов, которые уже использовались (и класса
+    // по умолчанию). В статической сборке все кольца сразу максимального размера.
+    void grow(uint32_t slots) {
+        tasks_.resize(slots);
+        const uint32_t capacity = uint32_t(tasks_.capacity());
+        free_.reserve(capacity);
+        cold_.resize(capacity);
+        groups_.reserve(capacity);
+        stats_.reserve(capacity);
+        timers_.reserve(capacity);
+#ifndef SCHEDULER_STATIC
+        for (uint32_t lane = 0; lane < kLanes; lane++) {
+            if (lane == SCHEDULER_PRIORITY_NORMAL || ready_[lane].capacity() > 0) ready_[lane].reserve(slots, capacity);
+        }
+#endif
+    }
+
+    // Кольцо класса выделяется при первой задаче этого класса, дальше растёт в grow.
+    void use_lane(uint32_t lane) {
+#ifndef SCHEDULER_STATIC
+        ready_[lane].reserve(tasks_.size(), tasks_.capacity());
+#else
+        (void)lane;
+#endif
+    }
+
+    void fire(uint32_t slot) {
+        Task& t = tasks_[slot];
+        // Задача уже ждёт выполнения — второй раз в очередь её не ставим, только копим runs.
+        if (!t.pending) {
+            ready_[t.priority].push(slot);
+            ready_size_++;
+            t.pending = true;
+        }
+        if (t.period_ms > 0) {
+            // Запуски next_run_ms, next_run_ms + period, ... не позже target_ms_.
+            const uint64_t missed = (target_ms_ - t.next_run_ms) / t.period_ms + 1;
+            const uint64_t runs = t.runs + missed;
+            t.runs = runs < t.max_runs ? uint32_t(runs) : t.max_runs;
+            t.next_run_ms += missed * t.period_ms;
+            t.seq = next_seq_++;
+            timers_.insert(slot);
+        } else {
+            t.runs = 1;
+            t.state = kFired;
+            active_--;
+        }
+    }
+
+    Array<Task> tasks_;             // горячие поля
+    Array<Cold> cold_;              // холодные поля
+    NameTable name_table_;
+    GroupTable groups_;             // холодные: группы задач
+    TaskStats stats_;               // холодные: статистика выполнения
+    Array<uint32_t> free_;
+    Engine<Array<Task>> timers_;
+    ReadyRing ready_[kLanes];       // очереди готовых по классам приоритета
+    uint32_t limit_ = kMaxSlots;    // предел числа слотов
+    size_t ready_size_ = 0;         // всего во всех очередях готовых
+    size_t active_ = 0;
+    uint64_t next_seq_ = 0;
+    uint64_t target_ms_ = 0;        // время, до которого идёт текущий advance_to
+};
+
+#if defined(SCHEDULER_ENGINE_HEAP)
+typedef BasicScheduler<TaskHeap> SchedulerImpl;
+#elif defined(SCHEDULER_ENGINE_SORTED)
+typedef BasicScheduler<SortedQueue> SchedulerImpl;
+#else
+typedef BasicScheduler<TimingWheel> SchedulerImpl;
+#endif
+
+#endif // SCHEDULER_IMPL_HPP
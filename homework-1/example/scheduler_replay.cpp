@@ -0,0 +1,173 @@
+// Воспроизведение трассы планировщика (.strace, см. trace_format.hpp) как бенчмарка.
+//
+// ./scheduler_replay trace.strace [wheel|heap|sorted|all]
+//
+// Такт — scheduler_update и все вызовы до следующего update. Для каждого движка
+// печатается число тактов в секунду и распределение времени такта; заодно сверяются
+// результаты с записанными (выданные id, число и порядок извлечённых задач),
+// так что расхождение поведения движка видно сразу.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "scheduler_impl.hpp"
+#include "trace_format.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+struct Stats {
+    std::vector<double> tick_ns;
+    double total_ns = 0;
+    size_t mismatches = 0;
+    size_t first_mismatch = 0;
+};
+
+template <class Impl>
+Stats replay(const std::vector<strace::Record>& records) {
+    size_t max_batch = 1;
+    size_t ticks = 0;
+    for (const strace::Record& r : records) {
+        if (r.op == strace::kPop || r.op == strace::kPopTasks || r.op == strace::kDrain) max_batch = std::max<size_t>(max_batch, r.arg);
+        if (r.op == strace::kUpdate) ticks++;
+    }
+    std::vector<uint32_t> ids(max_batch);
+    std::vector<SchedulerTaskInfo> tasks(max_batch);
+
+    Stats st;
+    st.tick_ns.reserve(ticks);
+    Impl s;
+    auto check = [&st](bool ok, size_t i) {
+        if (ok) return;
+        if (st.mismatches++ == 0) st.first_mismatch = i;
+    };
+
+    const Clock::time_point start = Clock::now();
+    Clock::time_point tick_start = start;
+    bool in_tick = false;
+    for (size_t i = 0; i < records.size(); i++) {
+        const strace::Record& r = records[i];
+        switch (r.op) {
+        case strace::kAdd:
+            check(s.add_task(r.name, r.arg, r.time) == r.id, i);
+            break;
+        case strace::kReserve:
+            check(s.reserve() == r.id, i);
+            break;
+        case strace::kActivate:
+            check((s.activate(r.id, r.name, r.arg, r.time) ? 0u : ~0u) == r.result, i);
+            break;
+        case strace::kRemove:
+            check((s.remove_task(r.id) ? 0u : ~0u) == r.result, i);
+            break;
+        case strace::kCatchup:
+            check((s.set_catchup(r.id, SchedulerCatchup(r.policy), r.arg) ? 0u : ~0u) == r.result, i);
+            break;
+        case strace::kGroup:
+            check((s.set_group(r.id, r.arg) ? 0u : ~0u) == r.result, i);
+            break;
+        case strace::kCancelGroup:
+            check(s.cancel_group(r.arg) == r.result, i);
+            break;
+        case strace::kPauseGroup:
+            check(s.pause_group(r.arg) == r.result, i);
+            break;
+        case strace::kResumeGroup:
+            check(s.resume_group(r.arg) == r.result, i);
+            break;
+        case strace::kShiftGroup:
+            check(s.shift_group(r.arg, int64_t(r.time)) == r.result, i);
+            break;
+        case strace::kPriority:
+            check((s.set_priority(r.id, SchedulerPriority(r.policy), r.arg) ? 0u : ~0u) == r.result, i);
+            break;
+        case strace::kReport:
+            check((s.report_run(r.id, r.arg) ? 0u : ~0u) == r.result, i);
+            break;
+        case strace::kDrain: {
+            uint64_t max_cost, spent;
+            std::memcpy(&max_cost, r.name, sizeof(max_cost));
+            const size_t n = s.drain(tasks.data(), r.arg, max_cost, spent);
+            uint64_t h = strace::kHashSeed;
+            for (size_t k = 0; k < n; k++) h = strace::hash_ids(h, tasks[k].id);
+            check(n == r.result && h == r.time, i);
+            break;
+        }
+        case strace::kUpdate: {
+            const Clock::time_point now = Clock::now();
+            if (in_tick) st.tick_ns.push_back(std::chrono::duration<double, std::nano>(now - tick_start).count());
+            tick_start = now;
+            in_tick = true;
+            s.advance_to(r.time);
+            break;
+        }
+        case strace::kPop:
+        case strace::kPopTasks: {
+            uint64_t h = strace::kHashSeed;
+            size_t n;
+            if (r.op == strace::kPop) {
+                n = s.pop_ready(ids.data(), r.arg);
+                for (size_t k = 0; k < n; k++) h = strace::hash_ids(h, ids[k]);
+            } else {
+                n = s.pop_ready(tasks.data(), r.arg);
+                for (size_t k = 0; k < n; k++) h = strace::hash_ids(h, tasks[k].id);
+            }
+            check(n == r.result && h == r.time, i);
+            break;
+        }
+        default:
+            check(false, i);
+            break;
+        }
+    }
+    const Clock::time_point end = Clock::now();
+    if (in_tick) st.tick_ns.push_back(std::chrono::duration<double, std::nano>(end - tick_start).count());
+    st.total_ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return st;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t i = size_t(p * double(sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+template <template <class> class Engine>
+void run(const char* engine, const std::vector<strace::Record>& records) {
+    Stats st = replay<BasicScheduler<Engine>>(records);
+    std::sort(st.tick_ns.begin(), st.tick_ns.end());
+    const double ticks = double(st.tick_ns.size());
+    std::printf("%-7s %10.0f ticks/s  tick ns: p50 %8.0f  p90 %8.0f  p99 %8.0f  p99.9 %8.0f  max %9.0f\n", engine,
+                st.total_ns > 0 ? ticks * 1e9 / st.total_ns : 0.0, percentile(st.tick_ns, 0.5),
+                percentile(st.tick_ns, 0.9), percentile(st.tick_ns, 0.99), percentile(st.tick_ns, 0.999),
+                st.tick_ns.empty() ? 0.0 : st.tick_ns.back());
+    if (st.mismatches > 0) {
+        std::printf("%-7s %zu results differ from the trace, first at record %zu\n", engine, st.mismatches,
+                    st.first_mismatch);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s trace.strace [wheel|heap|sorted|all]\n", argv[0]);
+        return 2;
+    }
+    const char* engine = argc > 2 ? argv[2] : "all";
+    std::vector<strace::Record> records;
+    if (!strace::read_all(argv[1], records)) {
+        std::fprintf(stderr, "%s: not a scheduler trace\n", argv[1]);
+        return 1;
+    }
+    std::printf("%zu records\n", records.size());
+
+    const bool all = std::strcmp(engine, "all") == 0;
+    if (all || std::strcmp(engine, "wheel") == 0) run<TimingWheel>("wheel", records);
+    if (all || std::strcmp(engine, "heap") == 0) run<TaskHeap>("heap", records);
+    if (all || std::strcmp(engine, "sorted") == 0) run<SortedQueue>("sorted", records);
+    return 0;
+}
@@ -0,0 +1,83 @@
+#define _XOPEN_SOURCE 700
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "scheduler.hpp"
+
+// Пример сборки SCHEDULER_SHARED: один планировщик на два процесса.
+// Блок лежит в файле, отображённом MAP_SHARED. Дочерний процесс отображает файл ещё раз —
+// по другому адресу, — подключается к планировщику и добавляет свои задачи;
+// родитель ведёт время и выполняет все задачи, свои и чужие.
+int main(void) {
+    const uint32_t max_tasks = 64;
+    const size_t bytes = scheduler_required_bytes(max_tasks);
+
+    char path[] = "/tmp/scheduler_shared_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || ftruncate(fd, (off_t)bytes) != 0) {
+        perror("scheduler file");
+        return 1;
+    }
+    unlink(path);
+
+    void* memory = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    Scheduler* s = scheduler_create_in(memory, bytes, max_tasks);
+    if (!s) {
+        printf("cannot create scheduler\n");
+        return 1;
+    }
+    scheduler_add_task(s, "parent_tick", 100, 100);
+
+    pid_t child = fork();
+    if (child < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (child == 0) {
+        // Унаследованное отображение ещё на месте, поэтому новое окажется по другому адресу.
+        void* view = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        Scheduler* mine = view == MAP_FAILED ? NULL : scheduler_attach(view, bytes);
+        if (!mine) {
+            printf("child: cannot attach\n");
+            fflush(stdout);
+            _exit(1);
+        }
+        printf("child: attached at another address: %s, tasks = %zu\n", view != memory ? "yes" : "no",
+               scheduler_task_count(mine));
+        scheduler_add_task(mine, "child_poll", 200, 200);
+        scheduler_add_task(mine, "child_report", 0, 250);
+        munmap(view, bytes);
+        fflush(stdout);
+        _exit(0);
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) return 1;
+    printf("parent: tasks = %zu\n", scheduler_task_count(s));
+
+    SchedulerTaskInfo ready[4];
+    for (uint64_t now = 0; now <= 400; now += 50) {
+        scheduler_update(s, now);
+        size_t remaining;
+        do {
+            size_t n = scheduler_pop_ready_tasks(s, ready, sizeof(ready) / sizeof(ready[0]), &remaining);
+            for (size_t i = 0; i < n; i++) {
+                printf("[%3llu ms] run %s\n", (unsigned long long)now, ready[i].name);
+            }
+        } while (remaining > 0);
+    }
+
+    scheduler_destroy(s);
+    munmap(memory, bytes);
+    close(fd);
+    return 0;
+}
@@ -0,0 +1,83 @@
+#ifndef SORTED_QUEUE_HPP
+#define SORTED_QUEUE_HPP
+
+#include <algorithm>
+#include <cstdint>
+
+#include "storage.hpp"
+
+// Самый простой движок: вектор, отсортированный по убыванию (next_run_ms, seq),
+// ближайшая задача — в конце. Извлечение O(1), но вставка и удаление — O(N)
+// из-за сдвига элементов. Нужен как точка отсчёта в бенчмарках.
+//
+// Интерфейс совпадает с TimingWheel: reserve / insert / erase / insert_many / erase_many / advance /
+// next_due / now.
+template <class Tasks>
+class SortedQueue {
+public:
+    static const uint64_t kNever = ~uint64_t(0);
+
+    explicit SortedQueue(const Tasks& tasks) : tasks_(tasks) {}
+
+    void reserve(uint32_t slots) { items_.reserve(slots); }
+
+#ifdef SCHEDULER_STATIC
+    static constexpr size_t storage_bytes(uint32_t slots) { return Arena::bytes<Entry>(slots); }
+
+    void attach(Arena& arena, uint32_t slots) { items_.attach(arena.take<Entry>(slots), slots); }
+#endif
+
+    uint64_t now() const { return now_; }
+
+    uint64_t next_due() const { return items_.empty() ? kNever : items_.back().due; }
+
+    void insert(uint32_t slot) {
+        const Entry e = {tasks_[slot].next_run_ms, tasks_[slot].seq, slot};
+        items_.insert(std::lower_bound(items_.begin(), items_.end(), e, later), e);
+    }
+
+    void erase(uint32_t slot) {
+        // Ключ задачи не меняется, пока она в очереди, — ищем её двоичным поиском.
+        const Entry e = {tasks_[slot].next_run_ms, tasks_[slot].seq, slot};
+        auto it = std::lower_bound(items_.begin(), items_.end(), e, later);
+        if (it != items_.end() && it->slot == slot) items_.erase(it);
+    }
+
+    // Массовые операции над группой задач: each(f) вызывает f(slot) для каждой из n задач.
+    template <class Each>
+    void insert_many(size_t, Each each) {
+        each([this](uint32_t slot) { insert(slot); });
+    }
+
+    template <class Each>
+    void erase_many(size_t, Each each) {
+        each([this](uint32_t slot) { erase(slot); });
+    }
+
+    template <class Fire>
+    void advance(uint64_t now, Fire fire) {
+        if (now > now_) now_ = now;
+        while (!items_.empty() && items_.back().due <= now_) {
+            const uint32_t slot = items_.back().slot;
+            items_.pop_back();
+            fire(slot);
+        }
+    }
+
+private:
+    struct Entry {
+        uint64_t due;
+        uint64_t seq;
+        uint32_t slot;
+    };
+
+    static bool later(const Entry& a, const Entry& b) {
+        return a.due != b.due ? a.due > b.due : a.seq > b.seq;
+    }
+
+    BlockRef<const Tasks> tasks_;
+    Array<Entry> items_;
+    uint64_t now_ = 0;
+};
+
+#endif // SORTED_QUEUE_HPP
@@ -0,0 +1,146 @@
+#ifndef STORAGE_HPP
+#define STORAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Хранилище массивов планировщика.
+//
+// Обычная сборка — std::vector. В сборке SCHEDULER_STATIC (без кучи) массивы — FixedVector:
+// фиксированная ёмкость, память нарезается линейным распределителем Arena из одного блока,
+// который передал вызывающий код. Размер блока считается формулой storage_bytes() каждого
+// компонента, поэтому он известен на этапе компиляции.
+//
+// Внутри блока нет абсолютных адресов: FixedVector и BlockRef хранят смещение цели от самих
+// себя. Поэтому блок можно отобразить в несколько процессов по разным адресам (SCHEDULER_SHARED).
+
+// Линейный распределитель поверх чужого блока памяти; ничего не освобождает.
+class Arena {
+public:
+    static const size_t kAlign = alignof(std::max_align_t);
+
+    static constexpr size_t round(size_t bytes) { return (bytes + kAlign - 1) & ~(kAlign - 1); }
+
+    template <class T>
+    static constexpr size_t bytes(size_t n) { return round(n * sizeof(T)); }
+
+    Arena(void* memory, size_t size) : base_(static_cast<unsigned char*>(memory)), size_(size) {}
+
+    // Блок должен быть выровнен по kAlign, иначе take() вернёт nullptr.
+    template <class T>
+    T* take(size_t n) {
+        if ((reinterpret_cast<uintptr_t>(base_) & (kAlign - 1)) != 0) return nullptr;
+        const size_t need = bytes<T>(n);
+        if (need > size_ - used_) return nullptr;
+        T* p = reinterpret_cast<T*>(base_ + used_);
+        used_ += need;
+        return p;
+    }
+
+    size_t used() const { return used_; }
+
+private:
+    unsigned char* base_;
+    size_t size_;
+    size_t used_ = 0;
+};
+
+// Ссылка на объект в том же блоке (или в том же объекте): смещение от себя, а не адрес.
+// Объект с такой ссылкой нельзя копировать — копия указывала бы мимо.
+template <class T>
+class BlockRef {
+public:
+    explicit BlockRef(T& target) : offset_(reinterpret_cast<uintptr_t>(&target) - reinterpret_cast<uintptr_t>(this)) {}
+    BlockRef(const BlockRef&) = delete;
+    BlockRef& operator=(const BlockRef&) = delete;
+
+    T& get() const { return *reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(this) + offset_); }
+
+    template <class I>
+    auto operator[](I i) const -> decltype(get()[i]) { return get()[i]; }
+
+private:
+    uintptr_t offset_;
+};
+
+// Массив фиксированной ёмкости на чужой памяти; подмножество интерфейса std::vector,
+// которое нужно планировщику. Выход за ёмкость — ошибка вызывающего кода.
+// Память массива задаётся смещением от самого FixedVector (см. BlockRef).
+template <class T>
+class FixedVector {
+public:
+    typedef T* iterator;
+    typedef const T* const_iterator;
+
+    FixedVector() = default;
+    FixedVector(const FixedVector&) = delete;
+    FixedVector& operator=(const FixedVector&) = delete;
+
+    void attach(T* data, size_t capacity) {
+        offset_ = reinterpret_cast<uintptr_t>(data) - reinterpret_cast<uintptr_t>(this);
+        capacity_ = capacity;
+        size_ = 0;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return capacity_; }
+    bool empty() const { return size_ == 0; }
+
+    // Память уже есть: reserve только для совместимости с std::vector.
+    void reserve(size_t) {}
+
+    void resize(size_t n) { resize(n, T()); }
+
+    void resize(size_t n, const T& value) {
+        for (size_t i = size_; i < n; i++) new (data() + i) T(value);
+        size_ = n;
+    }
+
+    void clear() { size_ = 0; }
+
+    void push_back(const T& value) { new (data() + size_++) T(value); }
+    void pop_back() { size_--; }
+
+    T& back() { return data()[size_ - 1]; }
+    const T& back() const { return data()[size_ - 1]; }
+
+    T& operator[](size_t i) { return data()[i]; }
+    const T& operator[](size_t i) const { return data()[i]; }
+
+    iterator begin() { return data(); }
+    iterator end() { return data() + size_; }
+    const_iterator begin() const { return data(); }
+    const_iterator end() const { return data() + size_; }
+
+    iterator insert(iterator pos, const T& value) {
+        for (iterator it = end(); it != pos; --it) *it = *(it - 1);
+        *pos = value;
+        size_++;
+        return pos;
+    }
+
+    iterator erase(iterator pos) {
+        for (iterator it = pos; it + 1 != end(); ++it) *it = *(it + 1);
+        size_--;
+        return pos;
+    }
+
+private:
+    T* data() const { return reinterpret_cast<T*>(reinterpret_cast<uintptr_t>(this) + offset_); }
+
+    uintptr_t offset_ = 0;
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+};
+
+#ifdef SCHEDULER_STATIC
+template <class T>
+using Array = FixedVector<T>;
+#else
+template <class T>
+using Array = std::vector<T>;
+#endif
+
+#endif // STORAGE_HPP
@@ -0,0 +1,298 @@
+#ifndef SUBMISSION_QUEUE_HPP
+#define SUBMISSION_QUEUE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include "scheduler.hpp"
+#include "storage.hpp"
+
+// Очередь команд от других потоков (сборка SCHEDULER_MPSC).
+//
+// Поток цикла владеет планировщиком; остальные потоки только кладут команды
+// add/remove/set_catchup/set_group/set_priority в ограниченную lock-free очередь, а поток цикла применяет их
+// в начале каждого такта. Порядок применения — порядок в очереди, поэтому при одинаковом
+// порядке команд результат тот же, что и без потоков.
+//
+// Чтобы add сразу вернул настоящий id, поток цикла держит запас зарезервированных id
+// (BasicScheduler::reserve) во второй такой же очереди и пополняет его после каждого такта.
+//
+// drain и refill сообщают наблюдателю (Sink) о каждой применённой команде и каждом
+// зарезервированном id — из потока цикла, в порядке применения; так пишется трасса.
+
+// Ограниченная очередь Вьюкова: у каждой ячейки свой номер поколения,
+// push и pop — один CAS по своему счётчику, без мьютексов и без выделения памяти.
+// Ёмкость — степень двойки.
+template <class T>
+class BoundedQueue {
+public:
+    struct Cell {
+        std::atomic<size_t> seq;
+        T value;
+    };
+
+    BoundedQueue() = default;
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    ~BoundedQueue() {
+#ifndef SCHEDULER_STATIC
+        delete[] cells_;
+#endif
+    }
+
+#ifdef SCHEDULER_STATIC
+    static constexpr size_t storage_bytes(size_t capacity) { return Arena::bytes<Cell>(capacity); }
+
+    void attach(Arena& arena, size_t capacity) { init(arena.take<Cell>(capacity), capacity); }
+#else
+    bool allocate(size_t capacity) {
+        Cell* cells = new (std::nothrow) Cell[capacity];
+        if (!cells) return false;
+        init(cells, capacity);
+        return true;
+    }
+#endif
+
+    bool push(const T& value) {
+        size_t pos = tail_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            const size_t seq = cell.seq.load(std::memory_order_acquire);
+            if (seq == pos) {
+                if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (seq < pos) {
+                return false;   // заполнена
+            } else {
+                pos = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(T& value) {
+        size_t pos = head_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            const size_t seq = cell.seq.load(std::memory_order_acquire);
+            if (seq == pos + 1) {
+                if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = cell.value;
+                    cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (seq < pos + 1) {
+                return false;   // пуста
+            } else {
+                pos = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    void init(Cell* cells, size_t capacity) {
+        cells_ = cells;
+        mask_ = capacity - 1;
+        for (size_t i = 0; i < capacity; i++) {
+            new (&cells_[i]) Cell;
+            cells_[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    Cell* cells_ = nullptr;
+    size_t mask_ = 0;
+    // Счётчики производителей и потребителя — в разных кэш-линиях.
+    std::atomic<size_t> tail_{0};
+    char pad_[64 - sizeof(std::atomic<size_t>)];
+    std::atomic<size_t> head_{0};
+};
+
+template <class Impl>
+class SubmissionQueue {
+public:
+    enum Op : uint32_t { kAdd, kRemove, kCatchup, kGroup, kPriority, kReport };
+
+    struct Command {
+        uint32_t op;
+        uint32_t id;
+        uint32_t period_ms;     // для kCatchup — политика, для kGroup — группа, для kPriority — класс,
+                                // для kReport — длительность
+        uint64_t next_run_ms;   // для kCatchup — max_runs, для kPriority — стоимость
+        char name[SCHEDULER_NAME_LEN];
+    };
+
+    // Наблюдатель по умолчанию: ничего не делает.
+    struct NoSink {
+        void applied(const Command&, bool) {}
+        void reserved(uint32_t) {}
+    };
+
+    // capacity — ёмкость очереди команд и запаса id, степень двойки.
+    explicit SubmissionQueue(size_t capacity) : capacity_(capacity) {}
+
+#ifdef SCHEDULER_STATIC
+    static constexpr size_t storage_bytes(size_t capacity) {
+        return BoundedQueue<Command>::storage_bytes(capacity) + BoundedQueue<uint32_t>::storage_bytes(capacity);
+    }
+
+    void attach(Arena& arena) {
+        commands_.attach(arena, capacity_);
+        spare_ids_.attach(arena, capacity_);
+    }
+#else
+    bool allocate() { return commands_.allocate(capacity_) && spare_ids_.allocate(capacity_); }
+#endif
+
+    // Вызываются из любого потока.
+
+    // 0 — нет свободного id или очередь команд заполнена (повторить после следующего такта).
+    uint32_t add(const char* name, uint32_t period_ms, uint64_t next_run_ms) {
+        if (!admit()) return 0;
+        Command c = Command();
+        if (!spare_ids_.pop(c.id)) {
+            in_flight_.fetch_sub(1, std::memory_order_relaxed);
+            return 0;
+        }
+        c.op = kAdd;
+        c.period_ms = period_ms;
+        c.next_run_ms = next_run_ms;
+        size_t n = 0;
+        if (name) {
+            while (n + 1 < SCHEDULER_NAME_LEN && name[n]) n++;
+            std::memcpy(c.name, name, n);
+        }
+        commands_.push(c);
+        return c.id;
+    }
+
+    bool remove(uint32_t id) {
+        Command c = Command();
+        c.op = kRemove;
+        c.id = id;
+        return submit(c);
+    }
+
+    bool set_catchup(uint32_t id, SchedulerCatchup policy, uint32_t max_runs) {
+        Command c = Command();
+        c.op = kCatchup;
+        c.id = id;
+        c.period_ms = uint32_t(policy);
+        c.next_run_ms = max_runs;
+        return submit(c);
+    }
+
+    bool set_group(uint32_t id, uint32_t group) {
+        Command c = Command();
+        c.op = kGroup;
+        c.id = id;
+        c.period_ms = group;
+        return submit(c);
+    }
+
+    bool set_priority(uint32_t id, SchedulerPriority priority, uint32_t cost) {
+        Command c = Command();
+        c.op = kPriority;
+        c.id = id;
+        c.period_ms = uint32_t(priority);
+        c.next_run_ms = cost;
+        return submit(c);
+    }
+
+    bool report_run(uint32_t id, uint32_t duration) {
+        Command c = Command();
+        c.op = kReport;
+        c.id = id;
+        c.period_ms = duration;
+        return submit(c);
+    }
+
+    // Есть ли команды, ещё не применённые циклом (их число может расти одновременно с вызовом).
+    bool pending() const { return in_flight_.load(std::memory_order_acquire) != 0; }
+
+    // Вызывается только из потока цикла: применяет команды и пополняет запас id.
+    template <class Sink>
+    void drain(Impl& impl, Sink& sink) {
+        Command c;
+        while (commands_.pop(c)) {
+            in_flight_.fetch_sub(1, std::memory_order_release);
+            bool ok = false;
+            switch (c.op) {
+            case kAdd:
+                ok = impl.activate(c.id, c.name, c.period_ms, c.next_run_ms);
+                spare_count_--;     // каждый add расходует один id из запаса
+                break;
+            case kRemove: ok = impl.remove_task(c.id); break;
+            case kCatchup: ok = impl.set_catchup(c.id, SchedulerCatchup(c.period_ms), uint32_t(c.next_run_ms)); break;
+            case kGroup: ok = impl.set_group(c.id, c.period_ms); break;
+            case kPriority:
+                ok = impl.set_priority(c.id, SchedulerPriority(c.period_ms), uint32_t(c.next_run_ms));
+                break;
+            case kReport: ok = impl.report_run(c.id, c.period_ms); break;
+            }
+            sink.applied(c, ok);
+        }
+        refill(impl, sink);
+    }
+
+    template <class Sink>
+    void refill(Impl& impl, Sink& sink) {
+        while (spare_count_ < capacity_) {
+            const uint32_t id = impl.reserve();
+            if (id == 0) break;
+            spare_ids_.push(id);
+            spare_count_++;
+            sink.reserved(id);
+        }
+    }
+
+    void refill(Impl& impl) {
+        NoSink sink;
+        refill(impl, sink);
+    }
+
+    // Зарезервированные, но ещё не применённые id (включая взятые add, чья команда ещё в очереди).
+    size_t spare_count() const { return spare_count_; }
+
+    // Обходит запас id в порядке резервирования. Только поток цикла и только пока
+    // других потоков нет: id на время обхода вынимаются из очереди.
+    template <class F>
+    void for_each_spare(F f) {
+        const size_t n = spare_count_;
+        for (size_t i = 0; i < n; i++) {
+            uint32_t id;
+            if (!spare_ids_.pop(id)) break;
+            f(id);
+            spare_ids_.push(id);
+        }
+    }
+
+private:
+    // Место в очереди команд занимается заранее, поэтому push после admit() не может
+    // не удаться, и взятый из запаса id не потеряется.
+    bool admit() {
+        if (in_flight_.fetch_add(1, std::memory_order_acquire) >= capacity_) {
+            in_flight_.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    bool submit(const Command& c) {
+        if (!admit()) return false;
+        commands_.push(c);
+        return true;
+    }
+
+    size_t capacity_;
+    BoundedQueue<Command> commands_;
+    BoundedQueue<uint32_t> spare_ids_;
+    std::atomic<size_t> in_flight_{0};
+    size_t spare_count_ = 0;    // только поток цикла
+};
+
+#endif // SUBMISSION_QUEUE_HPP
@@ -0,0 +1,190 @@
+#ifndef TASK_HEAP_HPP
+#define TASK_HEAP_HPP
+
+#include <cstdint>
+
+#include "storage.hpp"
+
+// Индексированная 4-арная min-куча задач по ключу (next_run_ms, seq).
+//
+// Ключ хранится прямо в элементе кучи, чтобы просеивание не ходило в таблицу задач,
+// а плотная таблица pos_[slot] даёт позицию задачи в куче — поэтому удаление
+// произвольной задачи и перепланирование стоят O(log N), в отличие от std::priority_queue.
+// 4 потомка вместо 2: дерево вдвое ниже, а потомки лежат в одной-двух кэш-линиях.
+//
+// Интерфейс совпадает с TimingWheel: reserve / insert / erase / insert_many / erase_many / advance /
+// next_due / now.
+template <class Tasks>
+class TaskHeap {
+public:
+    static const uint32_t kNone = 0xFFFFFFFFu;
+    static const uint64_t kNever = ~uint64_t(0);
+
+    explicit TaskHeap(const Tasks& tasks) : tasks_(tasks) {}
+
+    void reserve(uint32_t slots) {
+        pos_.resize(slots, uint32_t(kNone));
+        heap_.reserve(slots);
+    }
+
+#ifdef SCHEDULER_STATIC
+    static constexpr size_t storage_bytes(uint32_t slots) {
+        return Arena::bytes<Entry>(slots) + Arena::bytes<uint32_t>(slots);
+    }
+
+    void attach(Arena& arena, uint32_t slots) {
+        heap_.attach(arena.take<Entry>(slots), slots);
+        pos_.attach(arena.take<uint32_t>(slots), slots);
+    }
+#endif
+
+    uint64_t now() const { return now_; }
+
+    uint64_t next_due() const { return heap_.empty() ? kNever : heap_[0].due; }
+
+    void insert(uint32_t slot) {
+        const Entry e = {tasks_[slot].next_run_ms, tasks_[slot].seq, slot};
+        // Перепланирование задачи, которая сейчас на вершине и срабатывает:
+        // меняем ключ на месте, одно просеивание вниз вместо pop + push.
+        if (slot == firing_) {
+            heap_[0] = e;
+            firing_ = kNone;
+            sift_down(0);
+            return;
+        }
+        heap_.push_back(e);
+        pos_[slot] = uint32_t(heap_.size() - 1);
+        sift_up(heap_.size() - 1);
+    }
+
+    void erase(uint32_t slot) {
+        const uint32_t i = pos_[slot];
+        if (i == kNone) return;
+        pos_[slot] = kNone;
+        const Entry last = heap_.back();
+        heap_.pop_back();
+        if (i == heap_.size()) return;
+        heap_[i] = last;
+        pos_[last.slot] = i;
+        if (i > 0 && less(last, heap_[(i - 1) / 4])) sift_up(i);
+        else sift_down(i);
+    }
+
+    // Массовые операции над группой задач: each(f) вызывает f(slot) для каждой из n задач.
+    // Если n * глубина >= N, вместо n просеиваний куча перестраивается целиком за O(N).
+    template <class Each>
+    void insert_many(size_t n, Each each) {
+        if (!rebuild_cheaper(n)) {
+            each([this](uint32_t slot) { insert(slot); });
+            return;
+        }
+        each([this](uint32_t slot) {
+            const Entry e = {tasks_[slot].next_run_ms, tasks_[slot].seq, slot};
+            heap_.push_back(e);
+            pos_[slot] = uint32_t(heap_.size() - 1);
+        });
+        heapify();
+    }
+
+    template <class Each>
+    void erase_many(size_t n, Each each) {
+        if (!rebuild_cheaper(n)) {
+            each([this](uint32_t slot) { erase(slot); });
+            return;
+        }
+        each([this](uint32_t slot) {
+            const uint32_t i = pos_[slot];
+            if (i == kNone) return;
+            heap_[i].slot = kNone;
+            pos_[slot] = kNone;
+        });
+        size_t j = 0;
+        for (size_t i = 0; i < heap_.size(); i++) {
+            if (heap_[i].slot == kNone) continue;
+            heap_[j] = heap_[i];
+            pos_[heap_[j].slot] = uint32_t(j);
+            j++;
+        }
+        heap_.resize(j);
+        heapify();
+    }
+
+    template <class Fire>
+    void advance(uint64_t now, Fire fire) {
+        if (now > now_) now_ = now;
+        while (!heap_.empty() && heap_[0].due <= now_) {
+            const uint32_t slot = heap_[0].slot;
+            firing_ = slot;
+            fire(slot);
+            // fire не перепланировал задачу (одноразовая) — снимаем вершину.
+            if (firing_ == slot) {
+                firing_ = kNone;
+                erase(slot);
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        uint64_t due;
+        uint64_t seq;
+        uint32_t slot;
+    };
+
+    static bool less(const Entry& a, const Entry& b) {
+        return a.due != b.due ? a.due < b.due : a.seq < b.seq;
+    }
+
+    bool rebuild_cheaper(size_t n) const {
+        size_t depth = 1;
+        for (size_t size = heap_.size(); size > 4; size /= 4) depth++;
+        return n * depth >= heap_.size();
+    }
+
+    // Построение кучи снизу вверх (Флойд): O(N).
+    void heapify() {
+        if (heap_.size() < 2) return;
+        for (size_t i = (heap_.size() - 2) / 4 + 1; i-- > 0;) sift_down(i);
+    }
+
+    void sift_up(size_t i) {
+        const Entry e = heap_[i];
+        while (i > 0) {
+            const size_t parent = (i - 1) / 4;
+            if (!less(e, heap_[parent])) break;
+            heap_[i] = heap_[parent];
+            pos_[heap_[i].slot] = uint32_t(i);
+            i = parent;
+        }
+        heap_[i] = e;
+        pos_[e.slot] = uint32_t(i);
+    }
+
+    void sift_down(size_t i) {
+        const Entry e = heap_[i];
+        const size_t n = heap_.size();
+        for (;;) {
+            const size_t first = 4 * i + 1;
+            if (first >= n) break;
+            size_t best = first;
+            const size_t last = first + 4 < n ? first + 4 : n;
+            for (size_t c = first + 1; c < last; c++) {
+                if (less(heap_[c], heap_[best])) best = c;
+            }
+            if (!less(heap_[best], e)) break;
+            heap_[i] = heap_[best];
+            pos_[heap_[i].slot] = uint32_t(i);
+            i = best;
+        }
+        heap_[i] = e;
+        pos_[e.slot] = uint32_t(i);
+    }
+
+    BlockRef<const Tasks> tasks_;
+    Array<Entry> heap_;
+    Array<uint32_t> pos_;           // слот -> индекс в heap_ или kNone
+    uint32_t firing_ = kNone;
+    uint64_t now_ = 0;
+};
+
+#endif // TASK_HEAP_HPP
@@ -0,0 +1,54 @@
+#ifndef TASK_STATS_HPP
+#define TASK_STATS_HPP
+
+#include <cstdint>
+
+#include "storage.hpp"
+
+// Статистика выполнения задач (холодные данные планировщика).
+//
+// Планировщик задачи не выполняет, поэтому длительность узнаёт только из отчёта вызывающего
+// кода (record). На задачу 16 байт: скользящее среднее (EWMA, вес нового замера 1/8), максимум,
+// число превышений оценки стоимости и число отчётов. Такт и извлечение этот массив не читают.
+//
+// Обычная сборка растит массив вместе с таблицей задач, в сборке SCHEDULER_STATIC
+// он сразу на max_tasks слотов.
+class TaskStats {
+public:
+    struct Entry {
+        float mean = 0;             // EWMA длительности
+        uint32_t max = 0;
+        uint32_t overruns = 0;      // длительность больше оценки стоимости
+        uint32_t reports = 0;
+    };
+
+#ifdef SCHEDULER_STATIC
+    static constexpr size_t storage_bytes(uint32_t slots) { return Arena::bytes<Entry>(slots); }
+
+    void attach(Arena& arena, uint32_t slots) { entries_.attach(arena.take<Entry>(slots), slots); }
+#endif
+
+    // Вызывается при росте таблицы задач.
+    void reserve(uint32_t slots) { entries_.resize(slots); }
+
+    // Новая задача в слоте начинает с пустой статистики.
+    void reset(uint32_t slot) { entries_[slot] = Entry(); }
+
+    void record(uint32_t slot, uint32_t duration, uint32_t cost) {
+        Entry& e = entries_[slot];
+        if (e.reports == 0) e.mean = float(duration);
+        else e.mean += (float(duration) - e.mean) * kWeight;
+        if (duration > e.max) e.max = duration;
+        if (duration > cost) e.overruns++;
+        e.reports++;
+    }
+
+    const Entry& get(uint32_t slot) const { return entries_[slot]; }
+
+private:
+    static constexpr float kWeight = 1.0f / 8;
+
+    Array<Entry> entries_;
+};
+
+#endif // TASK_STATS_HPP
@@ -0,0 +1,367 @@
+#ifndef TIMING_WHEEL_HPP
+#define TIMING_WHEEL_HPP
+
+#include <algorithm>
+#include <cstdint>
+
+#include "storage.hpp"
+
+// Зерно колеса — 2^SCHEDULER_WHEEL_GRAIN_BITS тиков на ячейку уровня 0: один тик при тике в мс,
+// около 64 мкс при тике в мкс или нс (SCHEDULER_TICK).
+#ifndef SCHEDULER_WHEEL_GRAIN_BITS
+#if defined(SCHEDULER_TICK_NS)
+#define SCHEDULER_WHEEL_GRAIN_BITS 16
+#elif defined(SCHEDULER_TICK_US)
+#define SCHEDULER_WHEEL_GRAIN_BITS 6
+#else
+#define SCHEDULER_WHEEL_GRAIN_BITS 0
+#endif
+#endif
+
+// Иерархическое колесо таймеров (внутренняя C++-часть планировщика).
+//
+// 6 уровней по 64 ячейки: ячейка уровня k покрывает 64^k зёрен, всего 2^36 зёрен (~795 дней
+// при тике и зерне в 1 мс); более дальние задачи лежат в списке переполнения и перекладываются
+// раз в 2^36 зёрен.
+// Задача кладётся на уровень старшего бита, в котором её время отличается от текущего,
+// и при наступлении времени своей ячейки "осыпается" на уровень ниже.
+// Занятость ячеек хранится битовыми масками, поэтому пустые миллисекунды не перебираются:
+// update() стоит O(уровней) на событие, а каждая задача переезжает не более 6 раз.
+//
+// Ячейка — цепочка блоков по 14 слотов (64 байта), а не список через слоты: перекладывание
+// ячейки читает блоки подряд и не ждёт промаха кэша на каждой задаче. Неполный блок в ячейке
+// только первый; удаление переносит на место задачи последний слот этого блока.
+// Блоки берутся из общего пула, рассчитанного на число слотов, поэтому advance не выделяет память.
+//
+// Зерно: при тике в мкс или нс ячейка уровня 0 — не один тик, а 2^kGrain тиков (около 64 мкс).
+// Иначе задача с периодом в миллисекунды лежала бы на один-три уровня выше и перекладывалась
+// чаще, а диапазон колеса сжался бы до часов или минут. С зерном на нагрузке бенчмарка такт стоит
+// столько же, сколько у миллисекундного колеса, а у цикла на 10 кГц шаг длиннее зерна.
+// Задачи текущего зерна лежат в отдельном списке: advance перебирает его, только когда
+// наступила самая ранняя из них, поэтому срабатывание точное до тика.
+// При зерне в один тик этот список всегда пуст.
+//
+// next_due() — начало первой занятой ячейки по тем же маскам, O(уровней), или точное время
+// из списка текущего зерна. Это нижняя граница ближайшего срабатывания: точная для зерна
+// и ячеек уровня 0 (задача ближе 64 зёрен), а для верхних — момент, когда ячейка осыпется
+// и граница уточнится; точный минимум стоил бы обхода ячейки.
+//
+// Колесо не хранит времена: оно читает next_run_ms и seq задачи из таблицы планировщика
+// (Tasks — контейнер с operator[] и полями next_run_ms, seq).
+template <class Tasks>
+class TimingWheel {
+public:
+    static const uint32_t kNone = 0xFFFFFFFFu;
+    static const uint64_t kNever = ~uint64_t(0);
+
+    explicit TimingWheel(const Tasks& tasks) : tasks_(tasks) {
+        for (uint32_t& h : heads_) h = kNone;
+        for (uint64_t& m : occupied_) m = 0;
+    }
+
+    // Вызывается при росте таблицы задач: после этого insert/update не выделяют память.
+    void reserve(uint32_t slots) {
+        pos_.resize(slots);
+        scratch_.reserve(slots);
+        const size_t chunks = chunks_for(slots);
+        if (chunks_.size() < chunks) {
+            const size_t old = chunks_.size();
+            chunks_.resize(chunks);
+            for (size_t c = chunks; c-- > old;) free_chunk(uint32_t(c));
+        }
+    }
+
+#ifdef SCHEDULER_STATIC
+    static constexpr size_t storage_bytes(uint32_t slots) {
+        return Arena::bytes<Pos>(slots) + Arena::bytes<Key>(slots) + Arena::bytes<Chunk>(chunks_for(slots));
+    }
+
+    void attach(Arena& arena, uint32_t slots) {
+        pos_.attach(arena.take<Pos>(slots), slots);
+        scratch_.attach(arena.take<Key>(slots), slots);
+        const size_t chunks = chunks_for(slots);
+        chunks_.attach(arena.take<Chunk>(chunks), chunks);
+        reserve(slots);
+    }
+#endif
+
+    uint64_t now() const { return now_; }
+
+    void insert(uint32_t slot) {
+        place(slot, tasks_[slot].next_run_ms, now_);
+    }
+
+    void erase(uint32_t slot) {
+        Pos& p = pos_[slot];
+        if (p.bucket == kNoBucket) return;
+        const uint32_t bucket = p.bucket;
+        p.bucket = kNoBucket;
+        // На место удалённой — последний слот первого (неполного) блока ячейки.
+        Chunk& head = chunks_[heads_[bucket]];
+        const uint32_t last = head.slots[--head.count];
+        if (last != slot) {
+            chunks_[p.chunk].slots[p.index] = last;
+            pos_[last].chunk = p.chunk;
+            pos_[last].index = p.index;
+        }
+        if (head.count == 0) {
+            const uint32_t empty = heads_[bucket];
+            heads_[bucket] = head.next;
+            free_chunk(empty);
+            if (heads_[bucket] == kNone && bucket < kOverflow) {
+                occupied_[bucket / kSlots] &= ~(uint64_t(1) << (bucket & kMask));
+            } else if (heads_[bucket] == kNone && bucket == kCurrent) {
+                current_due_ = kNever;
+            }
+        }
+    }
+
+    // Массовые операции над группой задач: each(f) вызывает f(slot) для каждой из n задач.
+    // В колесе вставка и удаление и так O(1).
+    template <class Each>
+    void insert_many(size_t, Each each) {
+        each([this](uint32_t slot) { insert(slot); });
+    }
+
+    template <class Each>
+    void erase_many(size_t, Each each) {
+        each([this](uint32_t slot) { erase(slot); });
+    }
+
+    // Время, раньше которого advance ничего не выдаст (now(), если есть наступившие задачи);
+    // kNever — колесо пусто.
+    uint64_t next_due() const {
+        if (heads_[kExpired] != kNone) return now_;
+        return std::min(next_event(), current_due_);
+    }
+
+    // Продвигает время до now и вызывает fire(slot) для каждой наступившей задачи
+    // в порядке (next_run_ms, seq). fire может снова вставлять задачи (перепланирование).
+    template <class Fire>
+    void advance(uint64_t now, Fire fire) {
+        // Задачи, добавленные "в прошлое" (next_run_ms <= now_), выдаются первыми.
+        while (heads_[kExpired] != kNone) fire_expired(fire);
+        for (;;) {
+            // Все задачи текущего зерна раньше любой ячейки, поэтому выдаются до перехода к ней.
+            if (current_due_ <= now) fire_current(now, fire);
+            if (now_ >= now) break;
+            const uint64_t t = next_event();
+            if (t > now) break;
+            now_ = t;
+            const uint64_t grain = now_ >> kGrain;
+            if (heads_[kOverflow] != kNone && (grain & (kRange - 1)) == 0) cascade(kOverflow, now);
+            for (int level = kLevels - 1; level >= 0; level--) {
+                const uint32_t idx = uint32_t(grain >> (kBits * level)) & kMask;
+                if (occupied_[level] & (uint64_t(1) << idx)) cascade(uint32_t(level) * kSlots + idx, now);
+            }
+            fire_expired(fire);
+        }
+        if (now > now_) now_ = now;
+    }
+
+private:
+    static const int kGrain = SCHEDULER_WHEEL_GRAIN_BITS;
+    static const int kBits = 6;
+    static const int kLevels = 6;
+    static const uint32_t kSlots = 1u << kBits;
+    static const uint32_t kMask = kSlots - 1;
+    static const uint64_t kRange = uint64_t(1) << (kBits * kLevels);
+    // Служебные списки после ячеек уровней: переполнение, текущее зерно и "уже наступившие".
+    static const uint32_t kOverflow = kLevels * kSlots;
+    static const uint32_t kCurrent = kOverflow + 1;
+    static const uint32_t kExpired = kCurrent + 1;
+    static const uint32_t kBuckets = kExpired + 1;
+    static const uint16_t kNoBucket = 0xFFFF;
+    static const uint32_t kChunkSlots = 14;
+    static const size_t kPrefetch = 8;
+
+    struct Chunk {
+        uint32_t slots[kChunkSlots];
+        uint32_t next;      // следующий блок ячейки или свободного списка
+        uint32_t count;
+    };
+
+    // Где лежит слот: блок, позиция в блоке и ячейка.
+    struct Pos {
+        uint32_t chunk = kNone;
+        uint16_t index = 0;
+        uint16_t bucket = kNoBucket;
+    };
+
+    // Ключ сортировки наступивших задач копируется из таблицы один раз,
+    // чтобы сортировка сравнивала соседние элементы, а не ходила по слотам.
+    struct Key {
+        uint64_t due;
+        uint64_t seq;
+        uint32_t slot;
+
+        bool operator<(const Key& o) const { return due != o.due ? due < o.due : seq < o.seq; }
+    };
+
+    // Блоков хватает всегда: все блоки ячейки, кроме первого, полны, а при перекладывании
+    // ячейки её блоки освобождаются по одному, так что сверх этого занят ещё один.
+    static constexpr size_t chunks_for(uint32_t slots) {
+        return (size_t(slots) + kChunkSlots - 1) / kChunkSlots + kBuckets + 2;
+    }
+
+    uint32_t take_chunk() {
+        const uint32_t c = free_chunks_;
+        free_chunks_ = chunks_[c].next;
+        return c;
+    }
+
+    void free_chunk(uint32_t c) {
+        chunks_[c].next = free_chunks_;
+        free_chunks_ = c;
+    }
+
+    // Задача текущего зерна, наступившая к limit (цели advance), сразу идёт в наступившие:
+    // раньше неё в этом advance выдаются только задачи прошлых зёрен.
+    void place(uint32_t slot, uint64_t due, uint64_t limit) {
+        uint32_t bucket;
+        if (due <= now_) {
+            bucket = kExpired;
+        } else {
+            const uint64_t diff = (due >> kGrain) ^ (now_ >> kGrain);
+            const int level = diff == 0 ? -1 : (63 - __builtin_clzll(diff)) / kBits;
+            if (level < 0 && due <= limit) {
+                bucket = kExpired;
+            } else if (level < 0) {
+                bucket = kCurrent;
+                current_due_ = std::min(current_due_, due);
+            }
+            else if (level >= kLevels) bucket = kOverflow;
+            else bucket = uint32_t(level) * kSlots + (uint32_t(due >> (kGrain + kBits * level)) & kMask);
+        }
+        push(slot, bucket);
+    }
+
+    void push(uint32_t slot, uint32_t bucket) {
+        uint32_t c = heads_[bucket];
+        if (c == kNone || chunks_[c].count == kChunkSlots) {
+            const uint32_t fresh = take_chunk();
+            chunks_[fresh].next = c;
+            chunks_[fresh].count = 0;
+            heads_[bucket] = c = fresh;
+        }
+        Chunk& chunk = chunks_[c];
+        Pos& p = pos_[slot];
+        p.chunk = c;
+        p.index = uint16_t(chunk.count);
+        p.bucket = uint16_t(bucket);
+        chunk.slots[chunk.count++] = slot;
+        if (bucket < kOverflow) occupied_[bucket / kSlots] |= uint64_t(1) << (bucket & kMask);
+    }
+
+    // Ближайшее время, когда нужно что-то сделать: начало первой занятой ячейки
+    // любого уровня или граница диапазона колеса для списка переполнения.
+    uint64_t next_event() const {
+        const uint64_t grain = now_ >> kGrain;
+        uint64_t best = kNever;
+        for (int level = 0; level < kLevels; level++) {
+            const uint64_t bits = occupied_[level];
+            if (!bits) continue;
+            // Все занятые ячейки уровня лежат строго после текущей.
+            const int j = __builtin_ctzll(bits);
+            const uint64_t span = uint64_t(1) << (kBits * (level + 1));
+            const uint64_t start = (grain & ~(span - 1)) | (uint64_t(j) << (kBits * level));
+            if (start < best) best = start;
+        }
+        if (heads_[kOverflow] != kNone) {
+            const uint64_t boundary = (grain | (kRange - 1)) + 1;
+            if (boundary < best) best = boundary;
+        }
+        return best == kNever ? kNever : best << kGrain;
+    }
+
+    // Перекладывает содержимое ячейки относительно нового now_ (limit — цель advance).
+    void cascade(uint32_t bucket, uint64_t limit) {
+        uint32_t c = heads_[bucket];
+        heads_[bucket] = kNone;
+        if (bucket < kOverflow) occupied_[bucket / kSlots] &= ~(uint64_t(1) << (bucket & kMask));
+        while (c != kNone) {
+            const Chunk& chunk = chunks_[c];
+            const uint32_t next = chunk.next;
+            if (next != kNone) {
+                for (uint32_t i = 0; i < chunks_[next].count; i++) {
+                    __builtin_prefetch(&tasks_[chunks_[next].slots[i]]);
+                }
+            }
+            for (uint32_t i = 0; i < chunk.count; i++) {
+                const uint32_t slot = chunk.slots[i];
+                place(slot, tasks_[slot].next_run_ms, limit);
+            }
+            free_chunk(c);
+            c = next;
+        }
+    }
+
+    // Задачи текущего зерна, наступившие к now, переходят в список наступивших и выдаются.
+    template <class Fire>
+    void fire_current(uint64_t now, Fire& fire) {
+        uint32_t c = heads_[kCurrent];
+        heads_[kCurrent] = kNone;
+        current_due_ = kNever;
+        while (c != kNone) {
+            const Chunk& chunk = chunks_[c];
+            const uint32_t next = chunk.next;
+            for (uint32_t i = 0; i < chunk.count; i++) {
+                const uint32_t slot = chunk.slots[i];
+                const uint64_t due = tasks_[slot].next_run_ms;
+                if (due <= now) {
+                    push(slot, kExpired);
+                } else {
+                    push(slot, kCurrent);
+                    current_due_ = std::min(current_due_, due);
+                }
+            }
+            free_chunk(c);
+            c = next;
+        }
+        if (heads_[kExpired] != kNone) fire_expired(fire);
+    }
+
+    template <class Fire>
+    void fire_expired(Fire& fire) {
+        scratch_.clear();
+        for (uint32_t c = heads_[kExpired]; c != kNone;) {
+            const Chunk& chunk = chunks_[c];
+            for (uint32_t i = 0; i < chunk.count; i++) {
+                const uint32_t slot = chunk.slots[i];
+                const Key k = {tasks_[slot].next_run_ms, tasks_[slot].seq, slot};
+                scratch_.push_back(k);
+                pos_[slot].bucket = kNoBucket;
+            }
+            const uint32_t next = chunk.next;
+            free_chunk(c);
+            c = next;
+        }
+        heads_[kExpired] = kNone;
+        // Внутри ячейки порядок зависит от истории вставок, поэтому
+        // для детерминированной выдачи сортируем по (next_run_ms, seq).
+        std::sort(scratch_.begin(), scratch_.end());
+        // После сортировки слоты идут вразброс: задачу и её позицию запрашиваем заранее.
+        const size_t n = scratch_.size();
+        for (size_t i = 0; i < n; i++) {
+            if (i + kPrefetch < n) {
+                __builtin_prefetch(&tasks_[scratch_[i + kPrefetch].slot], 1);
+                __builtin_prefetch(&pos_[scratch_[i + kPrefetch].slot], 1);
+            }
+            fire(scratch_[i].slot);
+        }
+    }
+
+    BlockRef<const Tasks> tasks_;   // смещение, а не адрес: блок может переехать (SCHEDULER_SHARED)
+    Array<Pos> pos_;                // слот -> место в ячейке
+    Array<Chunk> chunks_;           // пул блоков ячеек
+    Array<Key> scratch_;
+    uint32_t free_chunks_ = kNone;
+    uint32_t heads_[kBuckets];      // первый (неполный) блок ячейки
+    uint64_t occupied_[kLevels];
+    uint64_t now_ = 0;
+    // Самое раннее время в списке текущего зерна (kNever — пуст). После erase может быть
+    // меньше настоящего: тогда advance переберёт список зря, а next_due даст нижнюю границу.
+    uint64_t current_due_ = kNever;
+};
+
+#endif // TIMING_WHEEL_HPP
@@ -0,0 +1,208 @@
+#ifndef TRACE_FORMAT_HPP
+#define TRACE_FORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "scheduler.hpp"
+
+// Бинарная трасса вызовов планировщика (.strace) для воспроизведения в scheduler_replay.
+//
+//   заголовок, 16 байт (little-endian):
+//     magic "STRC" | u16 версия = 1 | u16 размер записи = 56 | u64 резерв
+//   тело: записи фиксированного размера, по одной на вызов, меняющий состояние:
+//     u8 op | u8 политика | u16 резерв | u32 id | u32 аргумент | u32 результат |
+//     u64 время | name[32]
+//
+//   op          id           аргумент     результат         время
+//   kAdd        выданный id  period_ms    —                 next_run_ms       (+ имя)
+//   kRemove     id           —            0 / -1            —
+//   kCatchup    id           max_runs     0 / -1            —                 (+ политика)
+//   kUpdate     —            —            —                 now_ms
+//   kPop        —            max_ids      число выданных    хэш выданных id
+//   kPopTasks   —            max_tasks    число выданных    хэш выданных id
+//   kGroup      id           группа       0 / -1            —
+//   kCancelGroup —           группа       число задач       —
+//   kPauseGroup  —           группа       число задач       —
+//   kResumeGroup —           группа       число задач       —
+//   kShiftGroup  —           группа       число задач       delta_ms (int64 как u64)
+//   kPriority   id           стоимость    0 / -1            —                 (+ класс в поле политики)
+//   kDrain      —            max_tasks    число выданных    хэш выданных id   (+ max_cost, u64 в начале имени)
+//   kReport     id           длительность 0 / -1            —
+//   kReserve    выданный id  —            —                 —
+//   kActivate   id           period_ms    0 / -1            next_run_ms       (+ имя)
+//
+// kReserve и kActivate пишет только сборка SCHEDULER_MPSC: там add берёт id из запаса,
+// зарезервированного заранее, и становится задачей, когда поток цикла применяет команду.
+// Остальные команды других потоков тоже пишутся в момент применения, а не вызова.
+//
+// Записи копируются в одну из двух половин буфера. Заполненная половина не пишется сразу:
+// запись переключается на вторую, а заполненную пишет в файл scheduler_trace_flush,
+// вызванный вне такта (в простое), так что на горячем пути остаётся memcpy 56 байт.
+// Если до заполнения второй половины flush так и не вызвали, первая пишется синхронно —
+// этот такт платит за fwrite 56 КБ.
+// Заголовок пишется первым, а длина тела не хранится: трасса, оборванная падением
+// процесса, читается до последней целой записи.
+namespace strace {
+
+static const char kMagic[4] = {'S', 'T', 'R', 'C'};
+static const uint16_t kVersion = 1;
+static const size_t kHeaderSize = 16;
+static const size_t kRecordSize = 56;
+static const size_t kBufferRecords = 1024;
+
+enum Op : uint8_t {
+    kAdd = 1,
+    kRemove,
+    kCatchup,
+    kUpdate,
+    kPop,
+    kPopTasks,
+    kGroup,
+    kCancelGroup,
+    kPauseGroup,
+    kResumeGroup,
+    kShiftGroup,
+    kPriority,
+    kDrain,
+    kReport,
+    kReserve,
+    kActivate,
+};
+
+struct Record {
+    uint8_t op = 0;
+    uint8_t policy = 0;
+    uint32_t id = 0;
+    uint32_t arg = 0;
+    uint32_t result = 0;
+    uint64_t time = 0;
+    char name[SCHEDULER_NAME_LEN] = {};
+};
+
+// FNV-1a по выданным id: сверяет порядок выдачи без записи каждого id.
+inline uint64_t hash_ids(uint64_t h, uint32_t id) {
+    for (int i = 0; i < 4; i++) {
+        h ^= uint8_t(id >> (8 * i));
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+static const uint64_t kHashSeed = 14695981039346656037ull;
+
+inline void put_le(unsigned char* p, uint64_t v, int n) {
+    for (int i = 0; i < n; i++) p[i] = (unsigned char)(v >> (8 * i));
+}
+inline uint64_t get_le(const unsigned char* p, int n) {
+    uint64_t v = 0;
+    for (int i = 0; i < n; i++) v |= uint64_t(p[i]) << (8 * i);
+    return v;
+}
+
+// Запись трассы: двойной буфер фиксированного размера внутри объекта, без выделения памяти.
+class Writer {
+public:
+    Writer() = default;
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    ~Writer() { close(); }
+
+    bool is_open() const { return f_ != nullptr; }
+
+    bool open(const char* path) {
+        if (f_ || !path) return false;
+        f_ = std::fopen(path, "wb");
+        if (!f_) return false;
+        unsigned char h[kHeaderSize] = {};
+        std::memcpy(h, kMagic, 4);
+        put_le(h + 4, kVersion, 2);
+        put_le(h + 6, kRecordSize, 2);
+        ok_ = std::fwrite(h, 1, kHeaderSize, f_) == kHeaderSize;
+        return ok_;
+    }
+
+    void add(const Record& r) {
+        unsigned char* p = buf_[active_] + used_ * kRecordSize;
+        p[0] = r.op;
+        p[1] = r.policy;
+        put_le(p + 2, 0, 2);
+        put_le(p + 4, r.id, 4);
+        put_le(p + 8, r.arg, 4);
+        put_le(p + 12, r.result, 4);
+        put_le(p + 16, r.time, 8);
+        std::memcpy(p + 24, r.name, SCHEDULER_NAME_LEN);
+        if (++used_ == kBufferRecords) swap();
+    }
+
+    // Пишет в файл заполненную половину и начатую. Вызывать вне такта.
+    void flush() {
+        if (!f_) return;
+        write_full();
+        if (used_ == 0) return;
+        ok_ = std::fwrite(buf_[active_], kRecordSize, used_, f_) == used_ && ok_;
+        used_ = 0;
+    }
+
+    // false — при записи была ошибка.
+    bool close() {
+        if (!f_) return true;
+        flush();
+        const bool ok = std::fclose(f_) == 0 && ok_;
+        f_ = nullptr;
+        return ok;
+    }
+
+private:
+    // Половина заполнена: запись переходит на другую. Прошлая заполненная половина,
+    // если flush её так и не забрал, пишется здесь, синхронно.
+    void swap() {
+        write_full();
+        full_ = true;
+        active_ ^= 1;
+        used_ = 0;
+    }
+
+    void write_full() {
+        if (!full_) return;
+        ok_ = std::fwrite(buf_[active_ ^ 1], kRecordSize, kBufferRecords, f_) == kBufferRecords && ok_;
+        full_ = false;
+    }
+
+    std::FILE* f_ = nullptr;
+    size_t used_ = 0;           // записей в активной половине
+    unsigned active_ = 0;
+    bool full_ = false;         // другая половина заполнена и ждёт flush
+    bool ok_ = true;
+    unsigned char buf_[2][kBufferRecords * kRecordSize];
+};
+
+// Чтение трассы целиком (для офлайн-инструмента). false — файл не открылся или это не трасса.
+inline bool read_all(const char* path, std::vector<Record>& records) {
+    std::FILE* f = std::fopen(path, "rb");
+    if (!f) return false;
+    unsigned char h[kHeaderSize];
+    bool ok = std::fread(h, 1, kHeaderSize, f) == kHeaderSize && std::memcmp(h, kMagic, 4) == 0 &&
+              get_le(h + 4, 2) == kVersion && get_le(h + 6, 2) == kRecordSize;
+    unsigned char p[kRecordSize];
+    while (ok && std::fread(p, 1, kRecordSize, f) == kRecordSize) {
+        Record r;
+        r.op = p[0];
+        r.policy = p[1];
+        r.id = uint32_t(get_le(p + 4, 4));
+        r.arg = uint32_t(get_le(p + 8, 4));
+        r.result = uint32_t(get_le(p + 12, 4));
+        r.time = get_le(p + 16, 8);
+        std::memcpy(r.name, p + 24, SCHEDULER_NAME_LEN);
+        records.push_back(r);
+    }
+    std::fclose(f);
+    return ok;
+}
+
+} // namespace strace
+
+#endif // TRACE_FORMAT_HPP
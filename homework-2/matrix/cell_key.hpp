@@ -0,0 +1,18 @@
+#ifndef CELL_KEY_HPP
+#define CELL_KEY_HPP
+
+#include <cstdint>
+
+// Координаты ячейки в одном 64-битном ключе: строка в старших 32 битах, столбец в младших.
+// Индексы — int32_t, отрицательные допустимы.
+typedef uint64_t CellKey;
+
+constexpr CellKey cell_key(int32_t row, int32_t col) {
+    return (CellKey(uint32_t(row)) << 32) | uint32_t(col);
+}
+
+constexpr int32_t cell_row(CellKey key) { return int32_t(uint32_t(key >> 32)); }
+
+constexpr int32_t cell_col(CellKey key) { return int32_t(uint32_t(key)); }
+
+#endif // CELL_KEY_HPP
@@ -0,0 +1,176 @@
+#ifndef CELL_TABLE_HPP
+#define CELL_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "cell_key.hpp"
+
+// Хранилище ячеек по умолчанию: плоская хэш-таблица с открытой адресацией
+// (линейное пробирование) по упакованному ключу CellKey.
+//
+// Ключи и значения — в двух отдельных массивах, поиск читает только ключи (8 байт на слот),
+// своих аллокаций у ячеек нет. Слот номер — старшие биты key * 2^64/φ (хэширование Фибоначчи),
+// так что диагонали и полосы, у которых различаются только младшие биты строки и столбца,
+// разбрасываются по всей таблице. Пустой слот помечен ключом kEmpty — это ячейка (-1, -1),
+// она хранится отдельно от таблицы.
+//
+// Удаление без надгробий (backward shift): следующие за удалённой ячейки цепочки сдвигаются
+// на освободившееся место, если это не уводит их раньше их домашнего слота. Поэтому
+// частое "присвоить значение по умолчанию" не засоряет таблицу и не удлиняет поиск.
+// Заполнение не больше 3/4, при превышении ёмкость удваивается.
+//
+// T должен конструироваться по умолчанию. Изменение таблицы делает итераторы недействительными.
+template <class T>
+class CellTable {
+public:
+    CellTable() { reset(kMinCapacity); }
+
+    size_t size() const { return size_ + (edge_ ? 1 : 0); }
+
+    // nullptr — ячейка свободна.
+    const T* find(CellKey key) const {
+        if (key == kEmpty) return edge_ ? &edge_value_ : nullptr;
+        for (size_t i = home(key);; i = (i + 1) & mask_) {
+            const CellKey k = keys_[i];
+            if (k == key) return &values_[i];
+            if (k == kEmpty) return nullptr;
+        }
+    }
+
+    void assign(CellKey key, const T& value) {
+        if (key == kEmpty) {
+            edge_value_ = value;
+            edge_ = true;
+            return;
+        }
+        size_t i = home(key);
+        for (;; i = (i + 1) & mask_) {
+            const CellKey k = keys_[i];
+            if (k == key) {
+                values_[i] = value;
+                return;
+            }
+            if (k == kEmpty) break;
+        }
+        keys_[i] = key;
+        values_[i] = value;
+        if (++size_ * 4 > keys_.size() * 3) grow();
+    }
+
+    // false — ячейка и так свободна.
+    bool erase(CellKey key) {
+        if (key == kEmpty) {
+            const bool had = edge_;
+            edge_ = false;
+            edge_value_ = T();
+            return had;
+        }
+        size_t i = home(key);
+        for (;; i = (i + 1) & mask_) {
+            const CellKey k = keys_[i];
+            if (k == key) break;
+            if (k == kEmpty) return false;
+        }
+        // Дыра в i: ячейку из j можно перенести в неё, если её домашний слот
+        // не лежит в циклическом интервале (i, j].
+        for (size_t j = (i + 1) & mask_; keys_[j] != kEmpty; j = (j + 1) & mask_) {
+            if (((j - home(keys_[j])) & mask_) >= ((j - i) & mask_)) {
+                keys_[i] = keys_[j];
+                values_[i] = std::move(values_[j]);
+                i = j;
+            }
+        }
+        keys_[i] = kEmpty;
+        values_[i] = T();
+        size_--;
+        return true;
+    }
+
+    void clear() {
+        reset(kMinCapacity);
+        edge_ = false;
+        edge_value_ = T();
+    }
+
+    // Обход занятых ячеек: сначала слоты таблицы по порядку, затем ячейка (-1, -1).
+    class const_iterator {
+    public:
+        CellKey key() const { return pos_ < table_->keys_.size() ? table_->keys_[pos_] : kEmpty; }
+
+        const T& value() const { return pos_ < table_->keys_.size() ? table_->values_[pos_] : table_->edge_value_; }
+
+        const_iterator& operator++() {
+            pos_++;
+            skip();
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return pos_ == other.pos_; }
+        bool operator!=(const const_iterator& other) const { return pos_ != other.pos_; }
+
+    private:
+        friend class CellTable;
+
+        const_iterator(const CellTable* table, size_t pos) : table_(table), pos_(pos) { skip(); }
+
+        void skip() {
+            const size_t n = table_->keys_.size();
+            while (pos_ < n && table_->keys_[pos_] == kEmpty) pos_++;
+            if (pos_ == n && !table_->edge_) pos_++;
+        }
+
+        const CellTable* table_;
+        size_t pos_;        // keys_.size() — ячейка (-1, -1), keys_.size() + 1 — конец
+    };
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, keys_.size() + 1); }
+
+private:
+    static constexpr CellKey kEmpty = ~CellKey(0);
+    static constexpr size_t kMinCapacity = 16;
+
+    size_t home(CellKey key) const { return size_t((key * 0x9E3779B97F4A7C15ull) >> shift_); }
+
+    void reset(size_t capacity) {
+        keys_.assign(capacity, kEmpty);
+        values_.assign(capacity, T());
+        mask_ = capacity - 1;
+        shift_ = 64;
+        while (capacity > 1) {
+            capacity >>= 1;
+            shift_--;
+        }
+        size_ = 0;
+    }
+
+    void grow() {
+        std::vector<CellKey> old_keys;
+        std::vector<T> old_values;
+        old_keys.swap(keys_);
+        old_values.swap(values_);
+        const size_t count = size_;
+        reset(old_keys.size() * 2);
+        for (size_t j = 0; j < old_keys.size(); j++) {
+            if (old_keys[j] == kEmpty) continue;
+            size_t i = home(old_keys[j]);
+            while (keys_[i] != kEmpty) i = (i + 1) & mask_;
+            keys_[i] = old_keys[j];
+            values_[i] = std::move(old_values[j]);
+        }
+        size_ = count;
+    }
+
+    std::vector<CellKey> keys_;
+    std::vector<T> values_;
+    size_t mask_ = 0;
+    unsigned shift_ = 64;       // 64 - log2(ёмкости)
+    size_t size_ = 0;           // без ячейки (-1, -1)
+    bool edge_ = false;         // занята ли ячейка (-1, -1)
+    T edge_value_ = T();
+};
+
+#endif // CELL_TABLE_HPP
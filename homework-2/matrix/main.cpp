@@ -0,0 +1,267 @@
+#include <iostream>
+#include <map>
+#include <random>
+#include <tuple>
+#include <utility>
+
+#include "map_storage.hpp"
+#include "matrix.hpp"
+#include "tile_storage.hpp"
+
+namespace {
+
+int g_failures = 0;
+
+// Проверка, которая работает и в Release (NDEBUG): печатает выражение, main вернёт 1.
+#define CHECK(expr)                                                                            \
+    do {                                                                                       \
+        if (!(expr)) {                                                                         \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK failed: " #expr << std::endl; \
+            g_failures++;                                                                      \
+        }                                                                                      \
+    } while (0)
+
+typedef std::map<std::pair<int, int>, int> Cells;
+
+// Содержимое матрицы по обходу; каждая ячейка должна встретиться один раз.
+template <class M>
+Cells cells_of(const M& matrix) {
+    Cells cells;
+    size_t visited = 0;
+    for (auto c : matrix) {
+        int i, j, v;
+        std::tie(i, j, v) = c;
+        CHECK(cells.emplace(std::make_pair(i, j), v).second);
+        visited++;
+    }
+    CHECK(visited == matrix.size());
+    return cells;
+}
+
+// Вариант тестирования из условия: главная и побочная диагонали 10 x 10.
+template <class M>
+void fill_diagonals(M& matrix) {
+    const int n = 10;
+    for (int i = 0; i < n; i++) {
+        matrix[i][i] = i;
+        matrix[i][n - 1 - i] = n - 1 - i;
+    }
+}
+
+// Пример из условия.
+template <template <class> class Storage>
+void example(bool print) {
+    Matrix<int, -1, Storage> matrix;
+    CHECK(matrix.size() == 0);
+
+    auto a = matrix[0][0];
+    CHECK(a == -1);
+    CHECK(matrix.size() == 0);
+
+    matrix[100][100] = 314;
+    CHECK(matrix[100][100] == 314);
+    CHECK(matrix.size() == 1);
+
+    for (auto c : matrix) {
+        int i, j, v;
+        std::tie(i, j, v) = c;
+        if (print) std::cout << i << j << v << std::endl;
+        CHECK(i == 100 && j == 100 && v == 314);
+    }
+
+    // Каноническая форма оператора =.
+    ((matrix[100][100] = 314) = 0) = 217;
+    CHECK(matrix[100][100] == 217);
+
+    matrix[100][100] = -1;
+    CHECK(matrix.size() == 0);
+    CHECK(matrix.begin() == matrix.end());
+}
+
+template <template <class> class Storage>
+void diagonals() {
+    Matrix<int, 0, Storage> matrix;
+    fill_diagonals(matrix);
+    CHECK(matrix.size() == 18);     // [0,0] и [9,0] получили значение по умолчанию
+
+    Cells expected;
+    for (int i = 0; i < 10; i++) {
+        if (i != 0) expected[std::make_pair(i, i)] = i;
+        if (9 - i != 0) expected[std::make_pair(i, 9 - i)] = 9 - i;
+    }
+    CHECK(cells_of(matrix) == expected);
+
+    const auto& view = matrix;
+    for (int i = -1; i <= 10; i++) {
+        for (int j = -1; j <= 10; j++) {
+            const Cells::const_iterator it = expected.find(std::make_pair(i, j));
+            CHECK(view[i][j] == (it == expected.end() ? 0 : it->second));
+        }
+    }
+}
+
+// Ячейки по обе стороны границ плиток 64 x 64 (63/64, -1/0, -65/-64) и повторное
+// использование плитки, из которой ушла последняя ячейка.
+template <template <class> class Storage>
+void tile_edges() {
+    Matrix<int, 0, Storage> matrix;
+    const int coords[] = {-65, -64, -1, 0, 63, 64};
+    Cells expected;
+    int value = 1;
+    for (int i : coords) {
+        for (int j : coords) {
+            matrix[i][j] = value;
+            expected[std::make_pair(i, j)] = value++;
+        }
+    }
+    CHECK(matrix.size() == expected.size());
+    CHECK(cells_of(matrix) == expected);
+    for (const auto& cell : expected) CHECK(matrix[cell.first.first][cell.first.second] == cell.second);
+    CHECK(matrix[-2][-2] == 0 && matrix[1][1] == 0 && matrix[62][65] == 0 && matrix[-63][-66] == 0);
+
+    // [64..127] x [64..127] держит одну ячейку; после её освобождения плитку займут другие,
+    // и старое значение не должно проступить ни в одной из них.
+    matrix[64][64] = 0;
+    expected.erase(std::make_pair(64, 64));
+    CHECK(matrix[64][64] == 0);
+    CHECK(matrix.size() == expected.size());
+    CHECK(cells_of(matrix) == expected);
+
+    matrix[1000][2000] = 7;
+    expected[std::make_pair(1000, 2000)] = 7;
+    CHECK(matrix[1000][2000] == 7);
+    CHECK(matrix[960][1984] == 0);      // то же место в плитке, что и [64][64]
+    CHECK(matrix[1000][1999] == 0 && matrix[1001][2000] == 0);
+    CHECK(cells_of(matrix) == expected);
+
+    for (const auto& cell : expected) matrix[cell.first.first][cell.first.second] = 0;
+    CHECK(matrix.size() == 0);
+    CHECK(matrix.begin() == matrix.end());
+}
+
+// Плитки обходятся в порядке создания, ячейки внутри плитки — по строкам.
+void tile_order() {
+    Matrix<int, 0, TileStorage> matrix;
+    matrix[70][5] = 1;      // плитка (1, 0)
+    matrix[3][9] = 2;       // плитка (0, 0)
+    matrix[64][63] = 3;
+    matrix[64][0] = 4;
+    matrix[2][10] = 5;
+    const std::tuple<int, int, int> expected[] = {
+        std::make_tuple(64, 0, 4), std::make_tuple(64, 63, 3), std::make_tuple(70, 5, 1),
+        std::make_tuple(2, 10, 5), std::make_tuple(3, 9, 2),
+    };
+    size_t k = 0;
+    for (auto c : matrix) {
+        CHECK(k < 5 && c == expected[k]);
+        k++;
+    }
+    CHECK(k == 5);
+}
+
+// Прямой доступ get/set и его согласие с прокси.
+template <template <class> class Storage>
+void get_set() {
+    Matrix<int, -1, Storage> matrix;
+    CHECK(matrix.get(5, 5) == -1);
+    CHECK(matrix.get(-1, -1) == -1);
+    CHECK(matrix.size() == 0);
+
+    matrix.set(5, 5, 10);
+    matrix.set(-1, -1, 11);
+    CHECK(matrix.size() == 2);
+    CHECK(matrix.get(5, 5) == 10 && matrix.get(-1, -1) == 11);
+
+    matrix.set(5, 5, -1);
+    CHECK(matrix.size() == 1);
+    CHECK(matrix.get(5, 5) == -1);
+    matrix.set(5, 5, -1);       // уже свободна
+    CHECK(matrix.size() == 1);
+
+    // Вперемешку через прокси и set: get видит то же, что matrix[i][j].
+    std::mt19937 rng(11);
+    for (int op = 0; op < 20000; op++) {
+        const int i = int(rng() % 130) - 65;
+        const int j = int(rng() % 130) - 65;
+        const int v = rng() % 3 == 0 ? -1 : int(rng() % 100);
+        if (op % 2) matrix.set(i, j, v);
+        else matrix[i][j] = v;
+        CHECK(matrix.get(i, j) == v);
+    }
+    const auto& view = matrix;
+    size_t occupied = 0;
+    bool same = true;
+    for (int i = -66; i <= 65; i++) {
+        for (int j = -66; j <= 65; j++) {
+            const int v = matrix.get(i, j);
+            same = same && v == matrix[i][j] && v == view[i][j];
+            if (v != -1) occupied++;
+        }
+    }
+    CHECK(same);
+    CHECK(occupied == matrix.size());
+    for (auto c : matrix) CHECK(matrix.get(std::get<0>(c), std::get<1>(c)) == std::get<2>(c));
+}
+
+// Случайные присваивания в окне вокруг начала координат против std::map.
+template <template <class> class Storage>
+void against_map() {
+    Matrix<int, 0, Storage> matrix;
+    Matrix<int, 0, MapStorage> reference;
+    std::mt19937 rng(7);
+    for (int op = 0; op < 50000; op++) {
+        const int i = int(rng() % 200) - 100;
+        const int j = int(rng() % 200) - 100;
+        const int v = rng() % 3 == 0 ? 0 : int(rng() % 100);
+        matrix[i][j] = v;
+        reference[i][j] = v;
+    }
+    CHECK(matrix.size() == reference.size());
+    CHECK(cells_of(matrix) == cells_of(reference));
+    const auto& view = matrix;
+    const auto& ref = reference;
+    bool same = true;
+    for (int i = -101; i <= 100; i++) {
+        for (int j = -101; j <= 100; j++) same = same && view[i][j] == ref[i][j];
+    }
+    CHECK(same);
+}
+
+template <template <class> class Storage>
+void run_tests() {
+    example<Storage>(false);
+    diagonals<Storage>();
+    tile_edges<Storage>();
+    get_set<Storage>();
+    against_map<Storage>();
+}
+
+} // namespace
+
+int main() {
+    example<CellTable>(true);
+    run_tests<CellTable>();
+    run_tests<TileStorage>();
+    run_tests<MapStorage>();
+    tile_order();
+
+    Matrix<int, 0> matrix;
+    fill_diagonals(matrix);
+    const auto& view = matrix;
+    for (int i = 1; i <= 8; i++) {
+        for (int j = 1; j <= 8; j++) {
+            if (j > 1) std::cout << ' ';
+            std::cout << view[i][j];
+        }
+        std::cout << std::endl;
+    }
+
+    std::cout << matrix.size() << std::endl;
+
+    for (const auto& cell : matrix) {
+        int i, j, v;
+        std::tie(i, j, v) = cell;
+        std::cout << "[" << i << "," << j << "] = " << v << std::endl;
+    }
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,63 @@
+#ifndef MAP_STORAGE_HPP
+#define MAP_STORAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+
+#include "cell_key.hpp"
+
+// Очевидное хранилище ячеек: std::map по паре (строка, столбец).
+// Узел дерева на каждую ячейку и O(log n) на поиск; оставлено как точка отсчёта
+// для matrix_bench и как хранилище с обходом по возрастанию позиции.
+template <class T>
+class MapStorage {
+    typedef std::map<std::pair<int32_t, int32_t>, T> Cells;
+
+public:
+    size_t size() const { return cells_.size(); }
+
+    const T* find(CellKey key) const {
+        typename Cells::const_iterator it = cells_.find(position(key));
+        return it == cells_.end() ? nullptr : &it->second;
+    }
+
+    void assign(CellKey key, const T& value) { cells_[position(key)] = value; }
+
+    bool erase(CellKey key) { return cells_.erase(position(key)) != 0; }
+
+    void clear() { cells_.clear(); }
+
+    class const_iterator {
+    public:
+        CellKey key() const { return cell_key(it_->first.first, it_->first.second); }
+
+        const T& value() const { return it_->second; }
+
+        const_iterator& operator++() {
+            ++it_;
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return it_ == other.it_; }
+        bool operator!=(const const_iterator& other) const { return it_ != other.it_; }
+
+    private:
+        friend class MapStorage;
+
+        explicit const_iterator(typename Cells::const_iterator it) : it_(it) {}
+
+        typename Cells::const_iterator it_;
+    };
+
+    const_iterator begin() const { return const_iterator(cells_.begin()); }
+    const_iterator end() const { return const_iterator(cells_.end()); }
+
+private:
+    static std::pair<int32_t, int32_t> position(CellKey key) { return std::make_pair(cell_row(key), cell_col(key)); }
+
+    Cells cells_;
+};
+
+#endif // MAP_STORAGE_HPP
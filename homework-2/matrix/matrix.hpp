@@ -0,0 +1,141 @@
+#ifndef MATRIX_HPP
+#define MATRIX_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <tuple>
+
+#include "cell_key.hpp"
+#include "cell_table.hpp"
+
+// Бесконечная разреженная матрица, заполненная значением Default.
+//
+// Хранятся только занятые ячейки; присваивание Default освобождает ячейку.
+// get(i, j) и set(i, j, v) — прямой доступ: один поиск в хранилище, без прокси.
+// matrix[i][j] возвращает прокси строки, затем прокси ячейки. Прокси — это указатель на матрицу
+// плюс строка или уже упакованный ключ, конструкторы constexpr, поэтому после встраивания
+// от них ничего не остаётся: чтение через прокси — тот же get, присваивание — тот же set.
+// Присваивания прокси можно сцеплять: ((matrix[100][100] = 314) = 0) = 217.
+//
+// Storage — хранилище занятых ячеек по ключу CellKey: CellTable (хэш-таблица, по умолчанию)
+// или MapStorage (std::map). Обход — по занятым ячейкам в порядке хранилища,
+// элемент — кортеж (строка, столбец, значение).
+template <class T, T Default, template <class> class Storage = CellTable>
+class Matrix {
+public:
+    typedef std::tuple<int32_t, int32_t, T> value_type;
+
+    class Cell {
+    public:
+        operator T() const { return matrix_->get(key_); }
+
+        Cell& operator=(const T& value) {
+            matrix_->set(key_, value);
+            return *this;
+        }
+
+        // matrix[1][1] = matrix[2][2] копирует значение, а не прокси.
+        Cell& operator=(const Cell& other) { return *this = T(other); }
+
+    private:
+        friend class Matrix;
+
+        constexpr Cell(Matrix* matrix, CellKey key) noexcept : matrix_(matrix), key_(key) {}
+
+        Matrix* matrix_;
+        CellKey key_;
+    };
+
+    class Row {
+    public:
+        constexpr Cell operator[](int32_t col) const noexcept { return Cell(matrix_, cell_key(row_, col)); }
+
+    private:
+        friend class Matrix;
+
+        constexpr Row(Matrix* matrix, int32_t row) noexcept : matrix_(matrix), row_(row) {}
+
+        Matrix* matrix_;
+        int32_t row_;
+    };
+
+    class ConstRow {
+    public:
+        T operator[](int32_t col) const { return matrix_->get(cell_key(row_, col)); }
+
+    private:
+        friend class Matrix;
+
+        constexpr ConstRow(const Matrix* matrix, int32_t row) noexcept : matrix_(matrix), row_(row) {}
+
+        const Matrix* matrix_;
+        int32_t row_;
+    };
+
+    class const_iterator {
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef std::tuple<int32_t, int32_t, T> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const value_type* pointer;
+        typedef value_type reference;
+
+        value_type operator*() const { return value_type(cell_row(it_.key()), cell_col(it_.key()), it_.value()); }
+
+        const_iterator& operator++() {
+            ++it_;
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator old = *this;
+            ++it_;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const { return it_ == other.it_; }
+        bool operator!=(const const_iterator& other) const { return it_ != other.it_; }
+
+    private:
+        friend class Matrix;
+
+        explicit const_iterator(typename Storage<T>::const_iterator it) : it_(it) {}
+
+        typename Storage<T>::const_iterator it_;
+    };
+
+    typedef const_iterator iterator;
+
+    constexpr Row operator[](int32_t row) noexcept { return Row(this, row); }
+    constexpr ConstRow operator[](int32_t row) const noexcept { return ConstRow(this, row); }
+
+    // Значение ячейки или Default, если она свободна.
+    T get(int32_t row, int32_t col) const { return get(cell_key(row, col)); }
+
+    // Присваивание Default освобождает ячейку.
+    void set(int32_t row, int32_t col, const T& value) { set(cell_key(row, col), value); }
+
+    // Число занятых ячеек.
+    size_t size() const { return cells_.size(); }
+
+    void clear() { cells_.clear(); }
+
+    const_iterator begin() const { return const_iterator(cells_.begin()); }
+    const_iterator end() const { return const_iterator(cells_.end()); }
+
+private:
+    T get(CellKey key) const {
+        const T* value = cells_.find(key);
+        return value ? *value : Default;
+    }
+
+    void set(CellKey key, const T& value) {
+        if (value == Default) cells_.erase(key);
+        else cells_.assign(key, value);
+    }
+
+    Storage<T> cells_;
+};
+
+#endif // MATRIX_HPP
@@ -0,0 +1,224 @@
+// Бенчмарк хранилищ ячеек матрицы: CellTable (открытая адресация по упакованному ключу),
+// TileStorage (плитки 64 x 64) и std::map по паре (строка, столбец).
+//
+// ./matrix_bench [cells] [random|diagonal|blob|all] [hash|tile|map|all]
+//
+// Узоры заполнения:
+//
+// * random — случайные позиции в квадрате 2^30 x 2^30 (совпадения почти исключены);
+// * diagonal — главная диагональ [0,0], [1,1], ..., как в тесте из условия;
+// * blob — плотные квадраты 128 x 128 в случайных местах (не по границам плиток).
+//
+// Для каждого хранилища и узора меряются фазы (нс на операцию):
+// заполнение (matrix[i][j] = v), чтение занятых ячеек в порядке заполнения — через прокси
+// matrix[i][j] и напрямую через get(i, j), чтение свободных ячеек, освобождение всех ячеек
+// присваиванием значения по умолчанию. Колонки hit и get должны совпадать: прокси
+// не должны стоить ничего сверх поиска.
+// Память на ячейку — живые байты кучи после заполнения (без накладных расходов malloc),
+// пик — максимум за время заполнения (рост таблицы).
+//
+// Позиции не хранятся, а заново порождаются генератором с тем же зерном, поэтому
+// память бенчмарка — только матрица. При 10^8 ячеек хэш-таблице нужно ~1.6 ГБ, std::map — ~5 ГБ.
+// Плитки на случайном заполнении стоят ~17 КБ на ячейку, поэтому tile/random
+// запускается, только если указан явно.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+
+#include "map_storage.hpp"
+#include "matrix.hpp"
+#include "tile_storage.hpp"
+
+// Учёт памяти: глобальные operator new/delete хранят размер блока перед ним.
+namespace {
+
+const size_t kHeader = alignof(std::max_align_t);
+size_t g_live_bytes = 0;
+size_t g_peak_bytes = 0;
+
+} // namespace
+
+void* operator new(size_t n) {
+    unsigned char* p = static_cast<unsigned char*>(std::malloc(n + kHeader));
+    if (!p) throw std::bad_alloc();
+    std::memcpy(p, &n, sizeof(n));
+    g_live_bytes += n;
+    if (g_live_bytes > g_peak_bytes) g_peak_bytes = g_live_bytes;
+    return p + kHeader;
+}
+
+void operator delete(void* ptr) noexcept {
+    if (!ptr) return;
+    unsigned char* p = static_cast<unsigned char*>(ptr) - kHeader;
+    size_t n;
+    std::memcpy(&n, p, sizeof(n));
+    g_live_bytes -= n;
+    std::free(p);
+}
+
+void* operator new[](size_t n) { return operator new(n); }
+void operator delete[](void* ptr) noexcept { operator delete(ptr); }
+void operator delete(void* ptr, size_t) noexcept { operator delete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { operator delete(ptr); }
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const uint64_t kSeed = 42;
+const uint64_t kMissSeed = 4242;
+
+// Последовательность позиций узора: одна и та же при одинаковом зерне.
+class Pattern {
+public:
+    enum Kind { kRandom, kDiagonal, kBlob };
+
+    Pattern(Kind kind, uint64_t seed, int32_t shift) : kind_(kind), rng_(seed), shift_(shift) {}
+
+    void next(int32_t& row, int32_t& col) {
+        switch (kind_) {
+        case kRandom:
+            random_position(row, col);
+            break;
+        case kDiagonal:
+            row = i_;
+            col = i_ + shift_;
+            break;
+        case kBlob:
+            if (i_ % kBlobCells == 0) random_position(blob_row_, blob_col_);
+            row = blob_row_ + (i_ % kBlobCells) / kBlobSide;
+            col = blob_col_ + (i_ % kBlobCells) % kBlobSide;
+            break;
+        }
+        i_++;
+    }
+
+private:
+    static const int32_t kBlobSide = 128;
+    static const int32_t kBlobCells = kBlobSide * kBlobSide;
+
+    void random_position(int32_t& row, int32_t& col) {
+        const uint64_t r = rng_();
+        row = int32_t(r & 0x3FFFFFFF);
+        col = int32_t((r >> 32) & 0x3FFFFFFF);
+    }
+
+    Kind kind_;
+    std::mt19937_64 rng_;
+    int32_t shift_;         // свободные ячейки диагонального узора — соседняя диагональ
+    int32_t i_ = 0;
+    int32_t blob_row_ = 0;
+    int32_t blob_col_ = 0;
+};
+
+Pattern::Kind pattern_kind(const char* pattern) {
+    if (std::strcmp(pattern, "random") == 0) return Pattern::kRandom;
+    if (std::strcmp(pattern, "diagonal") == 0) return Pattern::kDiagonal;
+    return Pattern::kBlob;
+}
+
+double ns_per_op(Clock::time_point start, size_t ops) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / double(ops);
+}
+
+template <template <class> class Storage>
+void run(const char* storage, const char* pattern, size_t cells) {
+    const Pattern::Kind kind = pattern_kind(pattern);
+    const size_t base_bytes = g_live_bytes;
+    g_peak_bytes = g_live_bytes;
+
+    Matrix<int, 0, Storage>* matrix = new Matrix<int, 0, Storage>;
+
+    Pattern fill(kind, kSeed, 0);
+    Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < cells; i++) {
+        int32_t row, col;
+        fill.next(row, col);
+        (*matrix)[row][col] = int(i | 1);
+    }
+    const double fill_ns = ns_per_op(start, cells);
+    const size_t live = g_live_bytes - base_bytes;
+    const size_t peak = g_peak_bytes - base_bytes;
+    const size_t occupied = matrix->size();
+
+    uint64_t checksum = 0;
+    Pattern hits(kind, kSeed, 0);
+    start = Clock::now();
+    for (size_t i = 0; i < cells; i++) {
+        int32_t row, col;
+        hits.next(row, col);
+        checksum += uint32_t(int((*matrix)[row][col]));
+    }
+    const double hit_ns = ns_per_op(start, cells);
+
+    Pattern gets(kind, kSeed, 0);
+    start = Clock::now();
+    for (size_t i = 0; i < cells; i++) {
+        int32_t row, col;
+        gets.next(row, col);
+        checksum += uint32_t(matrix->get(row, col));
+    }
+    const double get_ns = ns_per_op(start, cells);
+
+    const Matrix<int, 0, Storage>& view = *matrix;
+    Pattern misses(kind, kMissSeed, 1);
+    start = Clock::now();
+    for (size_t i = 0; i < cells; i++) {
+        int32_t row, col;
+        misses.next(row, col);
+        checksum += uint32_t(view[row][col]);
+    }
+    const double miss_ns = ns_per_op(start, cells);
+
+    Pattern frees(kind, kSeed, 0);
+    start = Clock::now();
+    for (size_t i = 0; i < cells; i++) {
+        int32_t row, col;
+        frees.next(row, col);
+        (*matrix)[row][col] = 0;
+    }
+    const double erase_ns = ns_per_op(start, cells);
+    const size_t left = matrix->size();
+    delete matrix;
+
+    std::printf("%-5s %-9s %10zu %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f %8.1f  %zu %llx\n", storage, pattern, occupied,
+                fill_ns, hit_ns, get_ns, miss_ns, erase_ns, double(live) / double(occupied), double(peak) / double(occupied), left,
+                (unsigned long long)checksum);
+}
+
+void run_storage(const std::string& storage, const char* pattern, size_t cells) {
+    if (storage == "hash") run<CellTable>("hash", pattern, cells);
+    else if (storage == "tile") run<TileStorage>("tile", pattern, cells);
+    else run<MapStorage>("map", pattern, cells);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const size_t cells = argc > 1 ? size_t(std::strtoull(argv[1], nullptr, 10)) : 1000000;
+    const std::string pattern = argc > 2 ? argv[2] : "all";
+    const std::string storage = argc > 3 ? argv[3] : "all";
+    if (cells == 0 || (pattern != "all" && pattern != "random" && pattern != "diagonal" && pattern != "blob") ||
+        (storage != "all" && storage != "hash" && storage != "tile" && storage != "map")) {
+        std::fprintf(stderr, "usage: %s [cells] [random|diagonal|blob|all] [hash|tile|map|all]\n", argv[0]);
+        return 1;
+    }
+
+    std::printf("%-5s %-9s %10s %8s %8s %8s %8s %8s %8s %8s  %s\n", "store", "pattern", "cells", "fill", "hit", "get",
+                "miss", "erase", "B/cell", "peak", "left checksum");
+    const char* patterns[] = {"random", "diagonal", "blob"};
+    const char* storages[] = {"hash", "tile", "map"};
+    for (const char* p : patterns) {
+        if (pattern != "all" && pattern != p) continue;
+        for (const char* s : storages) {
+            if (storage != "all" && storage != s) continue;
+            if (storage == "all" && std::strcmp(s, "tile") == 0 && std::strcmp(p, "random") == 0) continue;
+            run_storage(s, p, cells);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,176 @@
+#ifndef TILE_STORAGE_HPP
+#define TILE_STORAGE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "cell_key.hpp"
+#include "cell_table.hpp"
+
+// Хранилище плиток для матриц, разреженных в целом, но плотных местами
+// (диагонали, полосы, пятна).
+//
+// Плоскость разбита на плитки 64 x 64. Плитка — битовая карта занятости (строка плитки —
+// одно 64-битное слово) и плотный массив значений по строкам, 4096 * sizeof(T) байт.
+// Плитки ищутся в CellTable по ключу (строка >> 6, столбец >> 6) и лежат в отдельных
+// аллокациях; освободившаяся плитка удаляется из таблицы и переиспользуется.
+//
+// Соседние ячейки лежат в одной плитке: после поиска плитки чтение — проверка бита
+// и индекс в массиве, а фрагмент вроде [1,1]..[8,8] — это 8 строк одной плитки.
+// На плотном пятне ячейка стоит sizeof(T) + 1/8 байта плюс доля плитки в таблице;
+// зато плитка с единственной занятой ячейкой стоит целиком, поэтому тонкая диагональ
+// (64 ячейки на плитку) и особенно случайное заполнение здесь дороже, чем в CellTable.
+//
+// Обход — по плиткам в порядке создания, внутри плитки — по строкам.
+template <class T>
+class TileStorage {
+public:
+    size_t size() const { return size_; }
+
+    const T* find(CellKey key) const {
+        const uint32_t* index = tile_index_.find(tile_key(key));
+        if (!index) return nullptr;
+        const Tile& tile = *tiles_[*index];
+        const uint32_t cell = cell_in_tile(key);
+        return (tile.bits[cell >> 6] >> (cell & 63)) & 1 ? &tile.values[cell] : nullptr;
+    }
+
+    void assign(CellKey key, const T& value) {
+        const CellKey tkey = tile_key(key);
+        const uint32_t* index = tile_index_.find(tkey);
+        Tile& tile = index ? *tiles_[*index] : add_tile(tkey);
+        const uint32_t cell = cell_in_tile(key);
+        uint64_t& bits = tile.bits[cell >> 6];
+        const uint64_t bit = uint64_t(1) << (cell & 63);
+        if (!(bits & bit)) {
+            bits |= bit;
+            tile.count++;
+            size_++;
+        }
+        tile.values[cell] = value;
+    }
+
+    // false — ячейка и так свободна.
+    bool erase(CellKey key) {
+        const CellKey tkey = tile_key(key);
+        const uint32_t* index = tile_index_.find(tkey);
+        if (!index) return false;
+        Tile& tile = *tiles_[*index];
+        const uint32_t cell = cell_in_tile(key);
+        uint64_t& bits = tile.bits[cell >> 6];
+        const uint64_t bit = uint64_t(1) << (cell & 63);
+        if (!(bits & bit)) return false;
+        bits &= ~bit;
+        tile.values[cell] = T();
+        size_--;
+        if (--tile.count == 0) {
+            free_.push_back(*index);
+            tile_index_.erase(tkey);
+        }
+        return true;
+    }
+
+    void clear() {
+        tile_index_.clear();
+        tiles_.clear();
+        free_.clear();
+        size_ = 0;
+    }
+
+    // Занятых плиток.
+    size_t tiles() const { return tiles_.size() - free_.size(); }
+
+    class const_iterator {
+    public:
+        CellKey key() const {
+            const Tile& tile = *storage_->tiles_[tile_];
+            return cell_key(int32_t(uint32_t(tile.row) << kBits) + int32_t(cell_ >> kBits),
+                            int32_t(uint32_t(tile.col) << kBits) + int32_t(cell_ & kMask));
+        }
+
+        const T& value() const { return storage_->tiles_[tile_]->values[cell_]; }
+
+        const_iterator& operator++() {
+            cell_++;
+            skip();
+            return *this;
+        }
+
+        bool operator==(const const_iterator& other) const { return tile_ == other.tile_ && cell_ == other.cell_; }
+        bool operator!=(const const_iterator& other) const { return !(*this == other); }
+
+    private:
+        friend class TileStorage;
+
+        const_iterator(const TileStorage* storage, size_t tile) : storage_(storage), tile_(tile), cell_(0) { skip(); }
+
+        // Следующая занятая ячейка начиная с (tile_, cell_): пропуск пустых строк плитки
+        // по одному слову карты, пустых и свободных плиток — целиком.
+        void skip() {
+            for (; tile_ < storage_->tiles_.size(); tile_++, cell_ = 0) {
+                const Tile& tile = *storage_->tiles_[tile_];
+                if (tile.count == 0) continue;
+                while (cell_ < kCells) {
+                    const uint64_t rest = tile.bits[cell_ >> kBits] >> (cell_ & kMask);
+                    if (rest) {
+                        cell_ += uint32_t(__builtin_ctzll(rest));
+                        return;
+                    }
+                    cell_ = (cell_ | kMask) + 1;
+                }
+            }
+        }
+
+        const TileStorage* storage_;
+        size_t tile_;
+        uint32_t cell_;     // номер ячейки в плитке, строка * 64 + столбец
+    };
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, tiles_.size()); }
+
+private:
+    static constexpr uint32_t kBits = 6;
+    static constexpr uint32_t kSide = 1u << kBits;
+    static constexpr uint32_t kMask = kSide - 1;
+    static constexpr uint32_t kCells = kSide * kSide;
+
+    struct Tile {
+        uint64_t bits[kSide];   // строка плитки — слово, столбец — бит
+        T values[kCells];       // по строкам
+        uint32_t count;         // занятых ячеек
+        int32_t row;            // координаты плитки: строка >> 6, столбец >> 6
+        int32_t col;
+    };
+
+    static CellKey tile_key(CellKey key) { return cell_key(cell_row(key) >> kBits, cell_col(key) >> kBits); }
+
+    static uint32_t cell_in_tile(CellKey key) {
+        return ((uint32_t(cell_row(key)) & kMask) << kBits) | (uint32_t(cell_col(key)) & kMask);
+    }
+
+    Tile& add_tile(CellKey tkey) {
+        uint32_t index;
+        if (!free_.empty()) {
+            index = free_.back();
+            free_.pop_back();
+        } else {
+            index = uint32_t(tiles_.size());
+            tiles_.emplace_back(new Tile());
+        }
+        Tile& tile = *tiles_[index];
+        tile.row = cell_row(tkey);
+        tile.col = cell_col(tkey);
+        tile_index_.assign(tkey, index);
+        return tile;
+    }
+
+    CellTable<uint32_t> tile_index_;            // ключ плитки -> номер в tiles_
+    std::vector<std::unique_ptr<Tile>> tiles_;  // освобождённые (count == 0) — в free_
+    std::vector<uint32_t> free_;
+    size_t size_ = 0;
+};
+
+#endif // TILE_STORAGE_HPP
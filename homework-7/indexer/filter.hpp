@@ -0,0 +1,330 @@
+#ifndef FILTER_HPP
+#define FILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "tokenizer.hpp"
+
+// Поиск подстроки. На x86-64 — SSE2-фильтр по первому и последнему символу
+// образца (за такт проверяются 16 позиций), кандидаты добиваются memcmp.
+// Возвращает end, если вхождения нет.
+inline const char* find_substr(const char* p, const char* end, std::string_view needle) {
+    const size_t m = needle.size();
+    if (m == 0) return p;
+    if (size_t(end - p) < m) return end;
+    if (m == 1) {
+        const void* r = std::memchr(p, needle[0], size_t(end - p));
+        return r ? static_cast<const char*>(r) : end;
+    }
+    const char* last = end - m;  // последняя допустимая позиция начала
+#if defined(__SSE2__)
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i tail = _mm_set1_epi8(needle[m - 1]);
+    while (p + 16 <= last + 1) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + m - 1));
+        unsigned mask = unsigned(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, tail))));
+        while (mask != 0) {
+            const unsigned bit = unsigned(__builtin_ctz(mask));
+            if (std::memcmp(p + bit + 1, needle.data() + 1, m - 2) == 0) return p + bit;
+            mask &= mask - 1;
+        }
+        p += 16;
+    }
+#endif
+    for (; p <= last; ++p) {
+        if (p[0] == needle[0] && p[m - 1] == needle[m - 1] && std::memcmp(p, needle.data(), m) == 0) return p;
+    }
+    return end;
+}
+
+// Маленькое регулярное выражение для значений полей: литералы, `.`, `\d`, `\w`, `\s`,
+// классы `[a-z0-9]` и `[^...]`, квантификаторы `*`, `+`, `?`.
+// Сопоставление — всегда с целым значением (как будто есть ^ и $).
+// Альтернатив нет, поэтому выражение — цепочка атомов, и сопоставление идёт без отката:
+// множество достижимых позиций в цепочке продвигается на каждый байт значения,
+// O(длина значения * число атомов) при любом числе звёздочек.
+class SimpleRegex {
+public:
+    bool compile(std::string_view pat, std::string& error) {
+        atoms_.clear();
+        for (size_t i = 0; i < pat.size();) {
+            Atom a;
+            const char c = pat[i++];
+            if (c == '.') {
+                a.fill();
+            } else if (c == '\\') {
+                if (i == pat.size()) {
+                    error = "trailing backslash";
+                    return false;
+                }
+                a.escape(pat[i++]);
+            } else if (c == '[') {
+                bool negate = false;
+                if (i < pat.size() && pat[i] == '^') {
+                    negate = true;
+                    i++;
+                }
+                bool closed = false;
+                bool first = true;
+                while (i < pat.size()) {
+                    char lo = pat[i++];
+                    if (lo == ']' && !first) {
+                        closed = true;
+                        break;
+                    }
+                    first = false;
+                    if (lo == '\\' && i < pat.size()) {
+                        a.escape(pat[i++]);
+                        continue;
+                    }
+                    char hi = lo;
+                    if (i + 1 < pat.size() && pat[i] == '-' && pat[i + 1] != ']') {
+                        hi = pat[i + 1];
+                        i += 2;
+                    }
+                    for (int x = uint8_t(lo); x <= uint8_t(hi); x++) a.set(uint8_t(x));
+                }
+                if (!closed) {
+                    error = "unterminated [";
+                    return false;
+                }
+                if (negate) a.invert();
+            } else if (c == '*' || c == '+' || c == '?') {
+                error = "quantifier without atom";
+                return false;
+            } else {
+                a.set(uint8_t(c));
+            }
+            if (i < pat.size() && (pat[i] == '*' || pat[i] == '+' || pat[i] == '?')) a.quant = pat[i++];
+            if (a.quant == '+') {
+                // x+ == xx*
+                a.quant = 0;
+                atoms_.push_back(a);
+                a.quant = '*';
+            }
+            atoms_.push_back(a);
+        }
+        return true;
+    }
+
+    bool match(std::string_view s) const {
+        // Позиции 0..n, n — всё выражение сопоставлено; два множества битов подряд.
+        const size_t n = atoms_.size();
+        const size_t words = n / 64 + 1;
+        uint64_t small[8] = {};
+        std::vector<uint64_t> big;
+        uint64_t* cur = small;
+        if (2 * words > sizeof(small) / sizeof(small[0])) {
+            big.assign(2 * words, 0);
+            cur = big.data();
+        }
+        uint64_t* next = cur + words;
+        reach(cur, 0);
+        for (char ch : s) {
+            const uint8_t c = uint8_t(ch);
+            bool any = false;
+            for (size_t w = 0; w < words; w++) next[w] = 0;
+            for (size_t w = 0; w < words; w++) {
+                for (uint64_t bits = cur[w]; bits; bits &= bits - 1) {
+                    const size_t i = w * 64 + size_t(__builtin_ctzll(bits));
+                    if (i == n || !atoms_[i].test(c)) continue;
+                    reach(next, atoms_[i].quant == '*' ? i : i + 1);
+                    any = true;
+                }
+            }
+            if (!any) return false;
+            std::swap(cur, next);
+        }
+        return (cur[n / 64] >> (n % 64)) & 1;
+    }
+
+private:
+    struct Atom {
+        uint64_t bits[4] = {0, 0, 0, 0};
+        char quant = 0;
+
+        void set(uint8_t c) { bits[c >> 6] |= uint64_t(1) << (c & 63); }
+        bool test(uint8_t c) const { return (bits[c >> 6] >> (c & 63)) & 1; }
+        void fill() {
+            for (auto& b : bits) b = ~uint64_t(0);
+        }
+        void invert() {
+            for (auto& b : bits) b = ~b;
+        }
+        void escape(char e) {
+            if (e == 'd') {
+                for (int x = '0'; x <= '9'; x++) set(uint8_t(x));
+            } else if (e == 'w') {
+                const char* lower = ascii_table().lower;
+                for (int x = 0; x < 128; x++) {
+                    if (lower[x]) set(uint8_t(x));
+                }
+            } else if (e == 's') {
+                for (char x : std::string_view(" \t\r\n\f\v")) set(uint8_t(x));
+            } else {
+                set(uint8_t(e));
+            }
+        }
+    };
+
+    // Добавляет позицию i и все, куда из неё можно перейти, не читая байт (через x* и x?).
+    void reach(uint64_t* set, size_t i) const {
+        for (;;) {
+            uint64_t& w = set[i / 64];
+            const uint64_t bit = uint64_t(1) << (i % 64);
+            if (w & bit) return;
+            w |= bit;
+            if (i == atoms_.size() || (atoms_[i].quant != '*' && atoms_[i].quant != '?')) return;
+            i++;
+        }
+    }
+
+    std::vector<Atom> atoms_;
+};
+
+// Предикаты над строками лога. Внутри группы — ИЛИ, между группами — И:
+// (любой из levels) и (любой из greps) и (все field_matches).
+// fields — подсчёт только значений полей вида `name=value` вместо всех слов строки.
+struct FilterConfig {
+    struct FieldMatch {
+        std::string name;
+        SimpleRegex re;
+    };
+
+    std::vector<std::string> levels;
+    std::vector<std::string> greps;
+    std::vector<FieldMatch> field_matches;
+    std::vector<std::string> fields;
+
+    bool active() const { return !levels.empty() || !greps.empty() || !field_matches.empty() || !fields.empty(); }
+};
+
+// Значение поля заканчивается на пробеле или типичной для логов пунктуации.
+inline bool is_field_end(char c) {
+    switch (c) {
+    case ' ': case '\t': case '\r': case '\n': case ',': case ';': case '|':
+    case '[': case ']': case '(': case ')': case '"': case '\'':
+        return true;
+    default:
+        return false;
+    }
+}
+
+// Обходит все вхождения поля `name=` в строке [ls, le):
+// on_field(вид на "name=value", вид на value).
+template <class OnField>
+void for_each_field(const char* ls, const char* le, std::string_view name, OnField&& on_field) {
+    const char* lower = ascii_table().lower;
+    const char* p = ls;
+    while (p < le) {
+        const char* f = find_substr(p, le, name);
+        if (f == le) return;
+        const char* eq = f + name.size();
+        // Имя поля должно начинаться на границе слова и заканчиваться '='.
+        if (eq < le && *eq == '=' && (f == ls || !lower[uint8_t(f[-1])])) {
+            const char* v = eq + 1;
+            const char* ve = v;
+            while (ve < le && !is_field_end(*ve)) ++ve;
+            if (ve > v) on_field(std::string_view(f, size_t(ve - f)), std::string_view(v, size_t(ve - v)));
+            p = ve;
+        } else {
+            p = f + 1;
+        }
+    }
+}
+
+// Однопроходный фильтр строк. Буфер просматривается SIMD-поиском "якорных" образцов
+// (уровни, иначе подстроки, иначе имена полей); границы строки ищутся только вокруг
+// найденного вхождения, остальные предикаты проверяются внутри этой строки.
+// Строки без якоря не разбираются вовсе, так что стоимость растёт с объёмом совпавших байтов.
+class LineFilter {
+public:
+    explicit LineFilter(const FilterConfig& cfg) : cfg_(cfg) {
+        if (!cfg.levels.empty()) {
+            for (const auto& s : cfg.levels) anchors_.push_back(s);
+        } else if (!cfg.greps.empty()) {
+            for (const auto& s : cfg.greps) anchors_.push_back(s);
+        } else if (!cfg.field_matches.empty()) {
+            for (const auto& f : cfg.field_matches) anchors_.push_back(f.name + "=");
+        } else {
+            for (const auto& s : cfg.fields) anchors_.push_back(s + "=");
+        }
+        next_.resize(anchors_.size());
+    }
+
+    // on_line(ls, le) вызывается для каждой прошедшей строки, le указывает на '\n' или end.
+    template <class OnLine>
+    void scan(const char* p, const char* end, OnLine&& on_line) {
+        // next_[k] — ближайшее вхождение k-го якоря не раньше pos (кэш между строками).
+        for (auto& n : next_) n = nullptr;
+        const char* pos = p;
+        while (pos < end) {
+            const char* best = end;
+            for (size_t k = 0; k < anchors_.size(); k++) {
+                if (!next_[k] || next_[k] < pos) next_[k] = find_substr(pos, end, anchors_[k]);
+                if (next_[k] < best) best = next_[k];
+            }
+            if (best == end) return;
+            const void* nl = memrchr(pos, '\n', size_t(best - pos));
+            const char* ls = nl ? static_cast<const char*>(nl) + 1 : pos;
+            const void* nr = std::memchr(best, '\n', size_t(end - best));
+            const char* le = nr ? static_cast<const char*>(nr) : end;
+            if (accept(ls, le)) on_line(ls, le);
+            pos = le + 1;
+        }
+    }
+
+    const FilterConfig& config() const { return cfg_; }
+
+private:
+    static bool has_word(const char* ls, const char* le, std::string_view w) {
+        const char* lower = ascii_table().lower;
+        for (const char* p = ls; (p = find_substr(p, le, w)) != le; ++p) {
+            const char* e = p + w.size();
+            if ((p == ls || !lower[uint8_t(p[-1])]) && (e == le || !lower[uint8_t(*e)])) return true;
+        }
+        return false;
+    }
+
+    bool accept(const char* ls, const char* le) const {
+        if (!cfg_.levels.empty()) {
+            bool ok = false;
+            for (const auto& l : cfg_.levels) {
+                if ((ok = has_word(ls, le, l))) break;
+            }
+            if (!ok) return false;
+        }
+        if (!cfg_.greps.empty()) {
+            bool ok = false;
+            for (const auto& g : cfg_.greps) {
+                if ((ok = find_substr(ls, le, g) != le)) break;
+            }
+            if (!ok) return false;
+        }
+        for (const auto& fm : cfg_.field_matches) {
+            bool ok = false;
+            for_each_field(ls, le, fm.name, [&](std::string_view, std::string_view value) {
+                if (!ok) ok = fm.re.match(value);
+            });
+            if (!ok) return false;
+        }
+        return true;
+    }
+
+    const FilterConfig& cfg_;
+    std::vector<std::string> anchors_;
+    std::vector<const char*> next_;
+};
+
+#endif // FILTER_HPP
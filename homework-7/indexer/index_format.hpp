@@ -0,0 +1,268 @@
+#ifndef INDEX_FORMAT_HPP
+#define INDEX_FORMAT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Бинарный формат результата индексатора (.widx).
+//
+//   заголовок, 32 байта (little-endian):
+//     magic "WIDX" | u16 версия = 1 | u16 флаги = 0 |
+//     u64 число записей | u64 длина тела в байтах | u32 CRC-32 тела | u32 резерв
+//   тело: записи, отсортированные по ключу побайтово; каждая запись —
+//     varint общий префикс с предыдущим ключом | varint длина суффикса |
+//     суффикс | varint счётчик
+//
+// Префиксное сжатие хорошо работает на отсортированном словаре
+// (user_1234, user_1235, ...), varint — на скошенных частотах.
+// Заголовок пишется в конце (файл должен поддерживать seek), читатель
+// проверяет CRC и число записей, дочитав тело до конца.
+namespace widx {
+
+static constexpr char kMagic[4] = {'W', 'I', 'D', 'X'};
+static constexpr uint16_t kVersion = 1;
+static constexpr size_t kHeaderSize = 32;
+static constexpr size_t kBufferSize = 64 * 1024;
+
+// CRC-32 (IEEE 802.3, как в zlib), табличный вариант.
+class Crc32 {
+public:
+    void update(const char* p, size_t n) {
+        static const Table t;
+        uint32_t c = ~crc_;
+        for (size_t i = 0; i < n; i++) c = t.v[(c ^ uint8_t(p[i])) & 0xFF] ^ (c >> 8);
+        crc_ = ~c;
+    }
+    uint32_t value() const { return crc_; }
+
+private:
+    struct Table {
+        uint32_t v[256];
+        Table() {
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                v[i] = c;
+            }
+        }
+    };
+    uint32_t crc_ = 0;
+};
+
+inline void put_u16(char* p, uint16_t v) {
+    for (int i = 0; i < 2; i++) p[i] = char(v >> (8 * i));
+}
+inline void put_u32(char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = char(v >> (8 * i));
+}
+inline void put_u64(char* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = char(v >> (8 * i));
+}
+inline uint64_t get_le(const char* p, int n) {
+    uint64_t v = 0;
+    for (int i = 0; i < n; i++) v |= uint64_t(uint8_t(p[i])) << (8 * i);
+    return v;
+}
+
+// Потоковая запись: ключи подаются строго по возрастанию.
+class Writer {
+public:
+    bool open(const std::string& path) {
+        f_ = std::fopen(path.c_str(), "wb");
+        if (!f_) {
+            error_ = "cannot create " + path;
+            return false;
+        }
+        char zero[kHeaderSize] = {};
+        write_ok_ = std::fwrite(zero, 1, kHeaderSize, f_) == kHeaderSize;  // заголовок допишем в close()
+        buf_.reserve(kBufferSize + 64);
+        return true;
+    }
+
+    ~Writer() {
+        if (f_) std::fclose(f_);
+    }
+
+    // false — ключ не по возрастанию или запись в файл уже не удалась (ENOSPC, EFBIG...).
+    bool add(std::string_view key, uint64_t count) {
+        if (!write_ok_) {
+            error_ = "write failed";
+            return false;
+        }
+        if (entries_ > 0 && !(std::string_view(prev_) < key)) {
+            error_ = "keys must be strictly increasing";
+            return false;
+        }
+        size_t shared = 0;
+        const size_t lim = prev_.size() < key.size() ? prev_.size() : key.size();
+        while (shared < lim && prev_[shared] == key[shared]) shared++;
+        put_varint(shared);
+        put_varint(key.size() - shared);
+        buf_.append(key.data() + shared, key.size() - shared);
+        put_varint(count);
+        prev_.assign(key.data(), key.size());
+        entries_++;
+        if (buf_.size() >= kBufferSize && !flush()) {
+            error_ = "write failed";
+            return false;
+        }
+        return true;
+    }
+
+    bool close() {
+        if (!f_) return false;
+        flush();
+        char h[kHeaderSize] = {};
+        for (int i = 0; i < 4; i++) h[i] = kMagic[i];
+        put_u16(h + 4, kVersion);
+        put_u16(h + 6, 0);
+        put_u64(h + 8, entries_);
+        put_u64(h + 16, body_bytes_);
+        put_u32(h + 24, crc_.value());
+        // Короткая запись тела где-то раньше делает файл негодным, даже если заголовок записался.
+        bool ok = write_ok_ && std::fseek(f_, 0, SEEK_SET) == 0 &&
+                  std::fwrite(h, 1, kHeaderSize, f_) == kHeaderSize && std::fflush(f_) == 0 && !std::ferror(f_);
+        ok = std::fclose(f_) == 0 && ok;
+        f_ = nullptr;
+        if (!ok) error_ = "write failed";
+        return ok;
+    }
+
+    uint64_t entries() const { return entries_; }
+    const std::string& error() const { return error_; }
+
+private:
+    void put_varint(uint64_t v) {
+        while (v >= 0x80) {
+            buf_.push_back(char(v | 0x80));
+            v >>= 7;
+        }
+        buf_.push_back(char(v));
+    }
+
+    bool flush() {
+        if (buf_.empty() || !write_ok_) return write_ok_;
+        crc_.update(buf_.data(), buf_.size());
+        write_ok_ = std::fwrite(buf_.data(), 1, buf_.size(), f_) == buf_.size();
+        body_bytes_ += buf_.size();
+        buf_.clear();
+        return write_ok_;
+    }
+
+    std::FILE* f_ = nullptr;
+    bool write_ok_ = false;     // все fwrite до сих пор записали всё
+    std::string buf_;
+    std::string prev_;
+    uint64_t entries_ = 0;
+    uint64_t body_bytes_ = 0;
+    Crc32 crc_;
+    std::string error_;
+};
+
+// Потоковое чтение с буфером фиксированного размера: память O(kBufferSize + длина ключа).
+class Reader {
+public:
+    bool open(const std::string& path) {
+        path_ = path;
+        f_ = std::fopen(path.c_str(), "rb");
+        if (!f_) return fail("cannot open");
+        char h[kHeaderSize];
+        if (std::fread(h, 1, kHeaderSize, f_) != kHeaderSize) return fail("truncated header");
+        for (int i = 0; i < 4; i++) {
+            if (h[i] != kMagic[i]) return fail("not a .widx file");
+        }
+        if (get_le(h + 4, 2) != kVersion) return fail("unsupported version");
+        entries_ = get_le(h + 8, 8);
+        body_left_ = get_le(h + 16, 8);
+        crc_expected_ = uint32_t(get_le(h + 24, 4));
+        buf_.resize(kBufferSize);
+        return true;
+    }
+
+    ~Reader() {
+        if (f_) std::fclose(f_);
+    }
+
+    // Следующая запись; false — конец тела или ошибка (см. error()).
+    // Вид key действителен до следующего вызова.
+    bool next(std::string_view& key, uint64_t& count) {
+        if (!error_.empty()) return false;
+        if (read_ == entries_) {
+            if (body_left_ != 0 || pos_ != len_) return fail("trailing bytes");
+            if (crc_.value() != crc_expected_) return fail("checksum mismatch");
+            return false;
+        }
+        uint64_t shared, suffix;
+        if (!get_varint(shared) || !get_varint(suffix)) return false;
+        if (shared > key_.size()) return fail("corrupt prefix");
+        key_.resize(size_t(shared));
+        for (uint64_t i = 0; i < suffix; i++) {
+            char c;
+            if (!get_byte(c)) return false;
+            key_.push_back(c);
+        }
+        if (!get_varint(count)) return false;
+        read_++;
+        key = key_;
+        return true;
+    }
+
+    uint64_t entries() const { return entries_; }
+    const std::string& error() const { return error_; }
+    const std::string& path() const { return path_; }
+
+private:
+    bool fail(const char* what) {
+        if (error_.empty()) error_ = path_ + ": " + what;
+        return false;
+    }
+
+    bool refill() {
+        if (body_left_ == 0) return fail("truncated body");
+        const size_t want = body_left_ < buf_.size() ? size_t(body_left_) : buf_.size();
+        len_ = std::fread(&buf_[0], 1, want, f_);
+        pos_ = 0;
+        if (len_ == 0) return fail("truncated body");
+        body_left_ -= len_;
+        crc_.update(buf_.data(), len_);
+        return true;
+    }
+
+    bool get_byte(char& c) {
+        if (pos_ == len_ && !refill()) return false;
+        c = buf_[pos_++];
+        return true;
+    }
+
+    bool get_varint(uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            char c;
+            if (!get_byte(c)) return false;
+            v |= uint64_t(uint8_t(c) & 0x7F) << shift;
+            if (!(uint8_t(c) & 0x80)) return true;
+        }
+        return fail("corrupt varint");
+    }
+
+    std::FILE* f_ = nullptr;
+    std::string path_;
+    std::string buf_;
+    size_t pos_ = 0;
+    size_t len_ = 0;
+    uint64_t body_left_ = 0;
+    uint64_t entries_ = 0;
+    uint64_t read_ = 0;
+    uint32_t crc_expected_ = 0;
+    Crc32 crc_;
+    std::string key_;
+    std::string error_;
+};
+
+} // namespace widx
+
+#endif // INDEX_FORMAT_HPP
@@ -0,0 +1,178 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "index_format.hpp"
+
+// Слияние бинарных индексов (.widx) с разных узлов: потоковый k-way merge.
+// Память — O(k * 64 KiB) на буферы чтения плюс O(M) на топ, независимо от размера словаря.
+
+struct Args {
+    std::string out;        // пусто => не писать объединённый .widx
+    size_t top = 0;         // 0 => не печатать топ
+    std::vector<std::string> inputs;
+};
+
+static void print_usage(const char* prog) {
+    std::cout <<
+        "Usage: " << prog << " [options] <in.widx>...\n"
+        "Options:\n"
+        "  --out FILE        write merged index to FILE (.widx)\n"
+        "  --top M           print M most frequent words as text\n"
+        "\nExamples:\n"
+        "  " << prog << " --out cluster.widx --top 20 node*.widx\n";
+}
+
+static bool parse_args(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << name << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (key == "--help" || key == "-h") {
+            print_usage(argv[0]);
+            return false;
+        } else if (key == "--out") {
+            a.out = need("--out");
+        } else if (key == "--top") {
+            a.top = std::stoul(need("--top"));
+        } else if (!key.empty() && key[0] == '-') {
+            std::cerr << "Unknown option: " << key << "\n";
+            print_usage(argv[0]);
+            std::exit(2);
+        } else {
+            a.inputs.push_back(key);
+        }
+    }
+    if (a.inputs.empty() || (a.out.empty() && a.top == 0)) {
+        std::cerr << "Need at least one input and --out and/or --top\n";
+        print_usage(argv[0]);
+        std::exit(2);
+    }
+    return true;
+}
+
+// Топ-M за один проход: min-куча из M лучших (частота по убыванию, слово по возрастанию).
+class TopM {
+public:
+    explicit TopM(size_t m) : m_(m) {}
+
+    void offer(std::string_view w, uint64_t c) {
+        if (m_ == 0) return;
+        if (heap_.size() == m_ && !better(c, w, heap_.front().second, heap_.front().first)) return;
+        if (heap_.size() == m_) {
+            std::pop_heap(heap_.begin(), heap_.end(), cmp);
+            heap_.pop_back();
+        }
+        heap_.emplace_back(std::string(w), c);
+        std::push_heap(heap_.begin(), heap_.end(), cmp);
+    }
+
+    std::vector<std::pair<std::string, uint64_t>> sorted() {
+        std::vector<std::pair<std::string, uint64_t>> v = heap_;
+        std::sort(v.begin(), v.end(), cmp);
+        return v;
+    }
+
+private:
+    static bool better(uint64_t c1, std::string_view w1, uint64_t c2, std::string_view w2) {
+        return c1 != c2 ? c1 > c2 : w1 < w2;
+    }
+    // "Меньше" для кучи — лучше, поэтому на вершине худший из оставленных.
+    static bool cmp(const std::pair<std::string, uint64_t>& x, const std::pair<std::string, uint64_t>& y) {
+        return better(x.second, x.first, y.second, y.first);
+    }
+
+    size_t m_;
+    std::vector<std::pair<std::string, uint64_t>> heap_;
+};
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse_args(argc, argv, a)) return 0;
+
+    std::vector<std::unique_ptr<widx::Reader>> readers;
+    for (const auto& path : a.inputs) {
+        std::unique_ptr<widx::Reader> r(new widx::Reader);
+        if (!r->open(path)) {
+            std::cerr << r->error() << "\n";
+            return 1;
+        }
+        readers.push_back(std::move(r));
+    }
+
+    // Текущая запись каждого входа; ключ копируется, т.к. вид живёт до следующего next().
+    struct Head {
+        std::string key;
+        uint64_t count;
+        size_t src;
+    };
+    auto greater = [](const Head* x, const Head* y) { return x->key > y->key || (x->key == y->key && x->src > y->src); };
+    std::vector<Head> heads(readers.size());
+    std::priority_queue<Head*, std::vector<Head*>, decltype(greater)> pq(greater);
+
+    auto advance = [&](size_t i) -> bool {
+        std::string_view k;
+        uint64_t c;
+        if (!readers[i]->next(k, c)) return readers[i]->error().empty();
+        heads[i].key.assign(k.data(), k.size());
+        heads[i].count = c;
+        heads[i].src = i;
+        pq.push(&heads[i]);
+        return true;
+    };
+    for (size_t i = 0; i < readers.size(); i++) {
+        if (!advance(i)) {
+            std::cerr << readers[i]->error() << "\n";
+            return 1;
+        }
+    }
+
+    widx::Writer out;
+    if (!a.out.empty() && !out.open(a.out)) {
+        std::cerr << out.error() << "\n";
+        return 1;
+    }
+
+    TopM top(a.top);
+    std::string key;
+    while (!pq.empty()) {
+        key = pq.top()->key;
+        uint64_t total = 0;
+        while (!pq.empty() && pq.top()->key == key) {
+            Head* h = pq.top();
+            pq.pop();
+            total += h->count;
+            if (!advance(h->src)) {
+                std::cerr << readers[h->src]->error() << "\n";
+                return 1;
+            }
+        }
+        if (!a.out.empty() && !out.add(key, total)) {
+            std::cerr << out.error() << "\n";
+            return 1;
+        }
+        top.offer(key, total);
+    }
+
+    if (!a.out.empty()) {
+        if (!out.close()) {
+            std::cerr << out.error() << "\n";
+            return 1;
+        }
+        std::cerr << "merged " << readers.size() << " files, " << out.entries() << " words -> " << a.out << "\n";
+    }
+    for (const auto& [w, c] : top.sorted()) std::cout << w << " " << c << "\n";
+    return 0;
+}
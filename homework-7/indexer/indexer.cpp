@@ -0,0 +1,480 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "filter.hpp"
+#include "index_format.hpp"
+#include "numa.hpp"
+#include "tokenizer.hpp"
+#include "word_table.hpp"
+
+namespace fs = std::filesystem;
+
+static constexpr size_t kChunkBytes = 4 << 20;
+
+struct Args {
+    int threads = 0;        // 0 => std::thread::hardware_concurrency()
+    size_t top = 20;
+    size_t minlen = 1;
+    bool utf8 = false;
+    bool numa = false;
+    bool zero_copy = false;
+    size_t pin_mib = 1024;  // сколько MiB отображений поток держит до materialize()
+    bool stats = false;
+    FilterConfig filter;
+    std::string out_bin;    // пусто => только текстовый топ
+    std::string path;
+};
+
+static void print_usage(const char* prog) {
+    std::cout <<
+        "Usage: " << prog << " [options] <path>\n"
+        "Options:\n"
+        "  --threads K       number of worker threads (default: hardware concurrency)\n"
+        "  --top M           number of most frequent words to print (default: 20)\n"
+        "  --minlen L        minimal word length (default: 1)\n"
+        "  --utf8            treat Unicode letters and digits as word characters\n"
+        "  --numa            pin workers per NUMA node, node-local buffers, hierarchical merge\n"
+        "  --zero-copy       keep word keys as views into mapped files until merge\n"
+        "  --pin-mib N       per-thread budget of pinned mappings in MiB (default: 1024)\n"
+        "  --out-bin FILE    also write the whole dictionary to FILE in binary .widx format\n"
+        "  --stats           print timing and throughput to stderr\n"
+        "Filters (repeatable; OR within a kind, AND between kinds):\n"
+        "  --level LEVEL     only lines containing LEVEL as a whole word (e.g. ERROR)\n"
+        "  --grep TEXT       only lines containing TEXT\n"
+        "  --field-match N=RE  only lines whose field N= value fully matches RE\n"
+        "                    (literals, ., \\d, \\w, \\s, [a-z], [^...], *, +, ?)\n"
+        "  --field NAME      count values of NAME= fields instead of words\n"
+        "\nExamples:\n"
+        "  " << prog << " --threads 8 --top 20 --minlen 3 ./data\n"
+        "  " << prog << " --level ERROR --field code --field ip ./data\n"
+        "  " << prog << " --field-match 'code=5\\d\\d' --field ip ./data\n";
+}
+
+static bool parse_args(int argc, char** argv, Args& a) {
+    for (int i = 1; i < argc; i++) {
+        std::string key = argv[i];
+        auto need = [&](const char* name) -> std::string {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << name << "\n";
+                std::exit(2);
+            }
+            return argv[++i];
+        };
+
+        if (key == "--help" || key == "-h") {
+            print_usage(argv[0]);
+            return false;
+        } else if (key == "--threads") {
+            a.threads = std::stoi(need("--threads"));
+        } else if (key == "--top") {
+            a.top = std::stoul(need("--top"));
+        } else if (key == "--minlen") {
+            a.minlen = std::stoul(need("--minlen"));
+        } else if (key == "--utf8") {
+            a.utf8 = true;
+        } else if (key == "--numa") {
+            a.numa = true;
+        } else if (key == "--zero-copy") {
+            a.zero_copy = true;
+        } else if (key == "--pin-mib") {
+            a.pin_mib = std::stoul(need("--pin-mib"));
+        } else if (key == "--out-bin") {
+            a.out_bin = need("--out-bin");
+        } else if (key == "--stats") {
+            a.stats = true;
+        } else if (key == "--level") {
+            a.filter.levels.push_back(need("--level"));
+        } else if (key == "--grep") {
+            a.filter.greps.push_back(need("--grep"));
+        } else if (key == "--field") {
+            a.filter.fields.push_back(need("--field"));
+        } else if (key == "--field-match") {
+            std::string v = need("--field-match");
+            const size_t eq = v.find('=');
+            FilterConfig::FieldMatch fm;
+            std::string error;
+            if (eq == std::string::npos || eq == 0) {
+                error = "expected NAME=REGEX";
+            } else {
+                fm.name = v.substr(0, eq);
+                fm.re.compile(std::string_view(v).substr(eq + 1), error);
+            }
+            if (!error.empty()) {
+                std::cerr << "Bad --field-match '" << v << "': " << error << "\n";
+                std::exit(2);
+            }
+            a.filter.field_matches.push_back(std::move(fm));
+        } else if (!key.empty() && key[0] == '-') {
+            std::cerr << "Unknown option: " << key << "\n";
+            print_usage(argv[0]);
+            std::exit(2);
+        } else {
+            a.path = key;
+        }
+    }
+    if (a.threads == 0) a.threads = int(std::max(1u, std::thread::hardware_concurrency()));
+    if (a.threads < 1 || a.top < 1 || a.minlen < 1) {
+        std::cerr << "threads/top/minlen must be >= 1\n";
+        std::exit(2);
+    }
+    if (a.zero_copy && a.numa) {
+        // В режиме NUMA файлы читаются в переиспользуемый буфер: ссылаться в него нельзя.
+        std::cerr << "--zero-copy needs mmap-ed input and is ignored with --numa\n";
+        a.zero_copy = false;
+    }
+    if (a.path.empty()) {
+        std::cerr << "Missing <path>\n";
+        print_usage(argv[0]);
+        std::exit(2);
+    }
+    return true;
+}
+
+// Потокобезопасная очередь задач без busy-wait:
+// pop() ждёт на condition_variable, пока не появится элемент или очередь не закроют.
+template <class T>
+class BlockingQueue {
+public:
+    void push(T v) {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            items_.push_back(std::move(v));
+        }
+        cv_.notify_one();
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mu_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    bool pop(T& out) {
+        std::unique_lock<std::mutex> lock(mu_);
+        cv_.wait(lock, [&] { return closed_ || !items_.empty(); });
+        if (items_.empty()) return false;
+        out = std::move(items_.front());
+        items_.pop_front();
+        return true;
+    }
+
+private:
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<T> items_;
+    bool closed_ = false;
+};
+
+// Файл, отображённый в память только для чтения.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return;
+        struct stat st;
+        if (::fstat(fd, &st) == 0) {
+            size_ = size_t(st.st_size);
+            ok_ = true;
+            if (size_ > 0) {
+                void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (p == MAP_FAILED) {
+                    ok_ = false;
+                    size_ = 0;
+                } else {
+                    data_ = static_cast<const char*>(p);
+                    ::madvise(p, size_, MADV_SEQUENTIAL);
+                }
+            }
+        }
+        ::close(fd);
+    }
+
+    ~MappedFile() {
+        if (data_) ::munmap(const_cast<char*>(data_), size_);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    explicit operator bool() const { return ok_; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    bool ok_ = false;
+};
+
+static void producer(const fs::path& root, BlockingQueue<std::string>& queue) {
+    std::error_code ec;
+    if (fs::is_regular_file(root, ec)) {
+        queue.push(root.string());
+    } else {
+        for (fs::recursive_directory_iterator it(root, fs::directory_options::skip_permission_denied, ec), end;
+             !ec && it != end; it.increment(ec)) {
+            if (it->is_regular_file(ec)) queue.push(it->path().string());
+        }
+        if (ec) std::cerr << "Directory walk error: " << ec.message() << "\n";
+    }
+    queue.close();
+}
+
+// Чтение файла кусками в буфер потока (режим --numa): буфер выделен и
+// "тронут" уже привязанным потоком, поэтому лежит в памяти его узла,
+// тогда как страницы page cache под mmap могут оказаться на чужом узле.
+// Куски выравниваются по строкам (хвост без '\n' переносится в начало буфера),
+// чтобы фильтры видели строки целиком.
+static bool read_chunked(const std::string& path, char* buf, size_t cap, size_t& total,
+                         const std::function<void(const char*, const char*)>& on_chunk) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    total = 0;
+    size_t carry = 0;
+    for (;;) {
+        ssize_t n = ::read(fd, buf + carry, cap - carry);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            ::close(fd);
+            return false;
+        }
+        total += size_t(n);
+        const size_t len = carry + size_t(n);
+        if (n == 0) {
+            if (len > 0) on_chunk(buf, buf + len);
+            break;
+        }
+        const void* nl = memrchr(buf, '\n', len);
+        // Строка длиннее буфера отдаётся как есть.
+        const size_t cut = nl ? size_t(static_cast<const char*>(nl) - buf) + 1 : len;
+        on_chunk(buf, buf + cut);
+        carry = len - cut;
+        std::memmove(buf, buf + cut, carry);
+    }
+    ::close(fd);
+    return true;
+}
+
+// Промежуточная таблица узла NUMA для иерархического слияния:
+// потоки узла сливаются в неё, затем узлы — в глобальный индекс.
+struct NodeTable {
+    std::mutex mu;
+    std::unique_ptr<WordTable> table;
+};
+
+struct Worker {
+    const Args* args;
+    BlockingQueue<std::string>* queue;
+    ShardedTable* global;
+    std::atomic<uint64_t>* bytes_done;
+    std::atomic<uint64_t>* key_bytes;
+    const NumaNode* node = nullptr;     // только в режиме --numa
+    NodeTable* node_table = nullptr;
+};
+
+static void consumer(Worker w) {
+    const Args& a = *w.args;
+    if (w.node) pin_current_thread(*w.node);
+
+    // Таблица и буфер создаются после привязки: первое касание страниц
+    // происходит на узле этого потока (first-touch policy Linux).
+    WordTable local(1 << 14);
+    Tokenizer tok(a.minlen, a.utf8);
+
+    // --zero-copy: новые ключи, лежащие в текущем отображении, не копируются.
+    // Отображения остаются "приколотыми", пока не исчерпан бюджет --pin-mib;
+    // тогда ключи копируются в арену (materialize) и файлы отключаются.
+    std::vector<std::unique_ptr<MappedFile>> pinned;
+    size_t pinned_bytes = 0;
+    const char* map_lo = nullptr;
+    const char* map_hi = nullptr;
+    auto on_word = [&](std::string_view word) {
+        if (word.data() >= map_lo && word.data() < map_hi) local.add_view(word);
+        else local.add(word);
+    };
+
+    // С фильтрами токенизатор (или извлечение полей) видит только прошедшие строки.
+    const FilterConfig& fc = a.filter;
+    LineFilter filter(fc);
+    auto process = [&](const char* p, const char* end) {
+        if (!fc.active()) {
+            tok.feed(p, end, on_word);
+            return;
+        }
+        filter.scan(p, end, [&](const char* ls, const char* le) {
+            if (!fc.fields.empty()) {
+                for (const auto& name : fc.fields) {
+                    for_each_field(ls, le, name, [&](std::string_view field, std::string_view) { on_word(field); });
+                }
+                return;
+            }
+            // Вместе с '\n': последнее слово строки тоже закончится внутри буфера.
+            tok.feed(ls, le < end ? le + 1 : le, on_word);
+            tok.finish(on_word);
+        });
+    };
+
+    std::unique_ptr<char[]> chunk;
+    if (w.node) {
+        chunk.reset(new char[kChunkBytes]);
+        std::memset(chunk.get(), 0, kChunkBytes);
+    }
+
+    std::string path;
+    while (w.queue->pop(path)) {
+        size_t size = 0;
+        bool ok;
+        if (chunk) {
+            ok = read_chunked(path, chunk.get(), kChunkBytes, size,
+                              [&](const char* p, const char* end) { process(p, end); });
+            if (ok) tok.finish(on_word);
+        } else {
+            std::unique_ptr<MappedFile> file(new MappedFile(path));
+            ok = bool(*file);
+            size = file->size();
+            if (ok) {
+                if (a.zero_copy) {
+                    if (pinned_bytes + size > a.pin_mib * 1024 * 1024 && !pinned.empty()) {
+                        local.materialize();
+                        pinned.clear();
+                        pinned_bytes = 0;
+                    }
+                    map_lo = file->data();
+                    map_hi = file->data() + size;
+                }
+                process(file->data(), file->data() + size);
+                tok.finish(on_word);
+                map_lo = map_hi = nullptr;
+                if (a.zero_copy) {
+                    pinned_bytes += size;
+                    pinned.push_back(std::move(file));
+                }
+            }
+        }
+        if (!ok) {
+            std::cerr << "Failed to read: " << path << "\n";
+            continue;
+        }
+        w.bytes_done->fetch_add(size, std::memory_order_relaxed);
+    }
+    w.key_bytes->fetch_add(local.copied_bytes(), std::memory_order_relaxed);
+
+    if (w.node_table) {
+        // Первый уровень слияния — внутри узла.
+        std::lock_guard<std::mutex> lock(w.node_table->mu);
+        if (!w.node_table->table) w.node_table->table.reset(new WordTable(1 << 16));
+        local.for_each([&](std::string_view word, uint64_t c) { w.node_table->table->add(word, c); });
+    } else {
+        // Редкий merge: один раз на поток, каждый сегмент под своим mutex.
+        // Ключи-виды копируются здесь прямо в глобальную арену,
+        // а отображения освобождаются только после слияния.
+        w.global->merge(local);
+    }
+}
+
+int main(int argc, char** argv) {
+    Args a;
+    if (!parse_args(argc, argv, a)) return 0;
+
+    const auto t0 = std::chrono::steady_clock::now();
+
+    BlockingQueue<std::string> queue;
+    ShardedTable global;
+    std::atomic<uint64_t> bytes_done{0};
+    std::atomic<uint64_t> key_bytes{0};
+
+    std::vector<NumaNode> nodes;
+    if (a.numa) nodes = numa_topology();
+    std::vector<NodeTable> node_tables(nodes.size());
+
+    std::thread prod(producer, fs::path(a.path), std::ref(queue));
+    std::vector<std::thread> workers;
+    workers.reserve(size_t(a.threads));
+    for (int i = 0; i < a.threads; i++) {
+        Worker w{&a, &queue, &global, &bytes_done, &key_bytes};
+        if (a.numa) {
+            // Потоки раскладываются по узлам по кругу.
+            w.node = &nodes[size_t(i) % nodes.size()];
+            w.node_table = &node_tables[size_t(i) % nodes.size()];
+        }
+        workers.emplace_back(consumer, w);
+    }
+    prod.join();
+    for (auto& t : workers) t.join();
+
+    if (a.numa) {
+        // Второй уровень — между узлами: таблицу каждого узла читает поток
+        // этого же узла, межузловой трафик только на запись в глобальные сегменты.
+        std::vector<std::thread> mergers;
+        for (size_t n = 0; n < nodes.size(); n++) {
+            if (!node_tables[n].table) continue;
+            mergers.emplace_back([&, n] {
+                pin_current_thread(nodes[n]);
+                global.merge(*node_tables[n].table);
+            });
+        }
+        for (auto& t : mergers) t.join();
+    }
+
+    const auto t1 = std::chrono::steady_clock::now();
+
+    std::vector<std::pair<std::string_view, uint64_t>> all;
+    all.reserve(global.size());
+    global.for_each([&](std::string_view w, uint64_t c) { all.emplace_back(w, c); });
+
+    if (!a.out_bin.empty()) {
+        // Весь словарь по возрастанию ключа — для потокового слияния index_merge.
+        std::sort(all.begin(), all.end());
+        widx::Writer out;
+        bool ok = out.open(a.out_bin);
+        for (size_t i = 0; ok && i < all.size(); i++) ok = out.add(all[i].first, all[i].second);
+        if (!ok || !out.close()) {
+            std::cerr << "Failed to write " << a.out_bin << ": " << out.error() << "\n";
+            return 1;
+        }
+    }
+
+    auto by_freq = [](const std::pair<std::string_view, uint64_t>& x, const std::pair<std::string_view, uint64_t>& y) {
+        if (x.second != y.second) return x.second > y.second;
+        return x.first < y.first;
+    };
+    const size_t m = std::min(a.top, all.size());
+    std::partial_sort(all.begin(), all.begin() + std::ptrdiff_t(m), all.end(), by_freq);
+    for (size_t i = 0; i < m; i++) std::cout << all[i].first << " " << all[i].second << "\n";
+
+    if (a.stats) {
+        const double sec = std::chrono::duration<double>(t1 - t0).count();
+        const double mib = double(bytes_done.load()) / (1024.0 * 1024.0);
+        std::cerr << "threads: " << a.threads;
+        if (a.numa) std::cerr << ", numa nodes: " << nodes.size();
+        std::cerr << ", unique words: " << all.size() << "\n"
+                  << "scanned " << mib << " MiB in " << sec << " s (" << (sec > 0 ? mib / sec : 0.0)
+                  << " MiB/s)\n"
+                  << "key bytes copied during scan: " << key_bytes.load() << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+// Топология NUMA без libnuma: читаем /sys/devices/system/node/node*/cpulist.
+// Если sysfs недоступен (не Linux, контейнер), считаем машину одним узлом.
+struct NumaNode {
+    int id = 0;
+    std::vector<int> cpus;
+};
+
+// Разбор строки вида "0-7,16-23".
+inline std::vector<int> parse_cpulist(const std::string& s) {
+    std::vector<int> cpus;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, ',')) {
+        if (part.empty() || part == "\n") continue;
+        const size_t dash = part.find('-');
+        const int lo = std::atoi(part.c_str());
+        const int hi = dash == std::string::npos ? lo : std::atoi(part.c_str() + dash + 1);
+        for (int c = lo; c <= hi; c++) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+inline std::vector<NumaNode> numa_topology() {
+    std::vector<NumaNode> nodes;
+    // Узлы нумеруются не обязательно подряд, но редко больше нескольких десятков.
+    for (int id = 0; id < 1024; id++) {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(id) + "/cpulist");
+        if (!in) {
+            if (id > 64 && !nodes.empty()) break;
+            continue;
+        }
+        std::string line;
+        std::getline(in, line);
+        NumaNode n;
+        n.id = id;
+        n.cpus = parse_cpulist(line);
+        // Узел без процессоров (только память) для рабочих потоков бесполезен.
+        if (!n.cpus.empty()) nodes.push_back(std::move(n));
+    }
+    if (nodes.empty()) {
+        NumaNode n;
+        const int ncpu = int(std::max(1u, std::thread::hardware_concurrency()));
+        for (int c = 0; c < ncpu; c++) n.cpus.push_back(c);
+        nodes.push_back(std::move(n));
+    }
+    return nodes;
+}
+
+// Привязывает текущий поток ко всем процессорам узла: планировщик ОС
+// может переносить поток между ядрами, но не между узлами.
+inline bool pin_current_thread(const NumaNode& node) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : node.cpus) {
+        if (c >= 0 && c < CPU_SETSIZE) CPU_SET(c, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+#endif // NUMA_HPP
@@ -0,0 +1,135 @@
+#ifndef TOKENIZER_HPP
+#define TOKENIZER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "utf8.hpp"
+
+// Таблица для ASCII: символ слова -> он же в нижнем регистре, разделитель -> 0.
+// Байты >= 0x80 по условию задачи считаются разделителями.
+struct AsciiTable {
+    char lower[256];
+
+    AsciiTable() {
+        for (int c = 0; c < 256; c++) {
+            char v = 0;
+            if (c >= 'a' && c <= 'z') v = char(c);
+            else if (c >= 'A' && c <= 'Z') v = char(c - 'A' + 'a');
+            else if (c >= '0' && c <= '9') v = char(c);
+            else if (c == '_') v = '_';
+            lower[c] = v;
+        }
+    }
+};
+
+inline const AsciiTable& ascii_table() {
+    static const AsciiTable t;
+    return t;
+}
+
+// Потоковый токенизатор: буфер можно подавать частями,
+// слово на границе кусков корректно склеивается.
+// Если слово целиком лежит во входном буфере и уже в нижнем регистре,
+// on_word получает вид прямо на входные байты, без копирования.
+// В режиме utf8 буквы и цифры Unicode тоже входят в слово,
+// а длина слова (minlen) считается в символах, а не в байтах.
+class Tokenizer {
+public:
+    Tokenizer(size_t minlen, bool utf8) : minlen_(minlen), utf8_(utf8), lower_(ascii_table().lower) {
+        word_.reserve(64);
+    }
+
+    template <class OnWord>
+    void feed(const char* p, const char* end, OnWord&& on_word) {
+        if (!utf8_) {
+            ascii_span(p, end, on_word);
+            return;
+        }
+        // ASCII-участки (векторная проверка) идут по быстрому табличному пути,
+        // через декодер проходят только не-ASCII символы.
+        while (p < end) {
+            const char* q = p + utf8::ascii_prefix(p, size_t(end - p));
+            if (q != p) ascii_span(p, q, on_word);
+            if (q == end) break;
+            p = utf8_run(q, end, on_word);
+        }
+    }
+
+    // Конец входа (файла): выдать недописанное слово.
+    template <class OnWord>
+    void finish(OnWord&& on_word) {
+        emit(on_word);
+    }
+
+private:
+    template <class OnWord>
+    void emit(OnWord& on_word) {
+        if (!word_.empty() && chars_ + word_.size() - bytes_ >= minlen_) on_word(std::string_view(word_));
+        word_.clear();
+        chars_ = 0;
+        bytes_ = 0;
+    }
+
+    template <class OnWord>
+    void ascii_span(const char* p, const char* end, OnWord& on_word) {
+        const char* lower = lower_;
+        while (p < end) {
+            if (word_.empty()) {
+                while (p < end && !lower[uint8_t(*p)]) ++p;
+                if (p == end) return;
+            }
+            const char* s = p;
+            bool same = true;
+            for (char c; p < end && (c = lower[uint8_t(*p)]); ++p) same &= c == *p;
+            const size_t n = size_t(p - s);
+            if (same && p < end && word_.empty()) {
+                if (n >= minlen_) on_word(std::string_view(s, n));
+                ++p;
+                continue;
+            }
+            const size_t old = word_.size();
+            word_.resize(old + n);
+            char* dst = &word_[old];
+            for (size_t i = 0; i < n; i++) dst[i] = lower[uint8_t(s[i])];
+            if (p < end) {
+                emit(on_word);
+                ++p;
+            }
+        }
+    }
+
+    // Обрабатывает подряд идущие не-ASCII символы, начиная с p.
+    // Возвращает позицию первого ASCII-байта (или end).
+    template <class OnWord>
+    const char* utf8_run(const char* p, const char* end, OnWord& on_word) {
+        while (p < end && uint8_t(*p) >= 0x80) {
+            size_t len;
+            const uint32_t cp = utf8::decode(p, end, len);
+            if (cp != 0xFFFFFFFFu && utf8::is_word(cp)) {
+                const size_t before = word_.size();
+                utf8::append(word_, utf8::fold(cp));
+                // Многобайтовый символ: байтов больше, чем символов.
+                chars_ += 1;
+                bytes_ += word_.size() - before;
+            } else {
+                emit(on_word);
+            }
+            p += len;
+        }
+        return p;
+    }
+
+    size_t minlen_;
+    bool utf8_;
+    const char* lower_;
+    std::string word_;
+    // Длина слова в символах = chars_ + (word_.size() - bytes_):
+    // chars_/bytes_ учитывают только не-ASCII часть.
+    size_t chars_ = 0;
+    size_t bytes_ = 0;
+};
+
+#endif // TOKENIZER_HPP
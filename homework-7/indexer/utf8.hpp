@@ -0,0 +1,185 @@
+#ifndef UTF8_HPP
+#define UTF8_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace utf8 {
+
+// Длина ASCII-префикса: сколько байтов с начала не имеют выставленного старшего бита.
+// На x86-64 — SSE2 по 16 байт, иначе SWAR по 8 байт.
+inline size_t ascii_prefix(const char* p, size_t n) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    for (; i + 16 <= n; i += 16) {
+        const int mask = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+        if (mask != 0) return i + size_t(__builtin_ctz(unsigned(mask)));
+    }
+#endif
+    for (; i + 8 <= n; i += 8) {
+        uint64_t v;
+        std::memcpy(&v, p + i, 8);
+        if (v & 0x8080808080808080ull) break;
+    }
+    while (i < n && uint8_t(p[i]) < 0x80) i++;
+    return i;
+}
+
+// Декодирует один символ, начинающийся с *p (старший бит выставлен).
+// Некорректные и обрезанные последовательности дают 0xFFFFFFFF и длину 1.
+inline uint32_t decode(const char* p, const char* end, size_t& len) {
+    const uint8_t b0 = uint8_t(p[0]);
+    uint32_t cp;
+    size_t n;
+    if (b0 >= 0xC2 && b0 <= 0xDF) {
+        cp = b0 & 0x1F;
+        n = 2;
+    } else if (b0 >= 0xE0 && b0 <= 0xEF) {
+        cp = b0 & 0x0F;
+        n = 3;
+    } else if (b0 >= 0xF0 && b0 <= 0xF4) {
+        cp = b0 & 0x07;
+        n = 4;
+    } else {
+        len = 1;
+        return 0xFFFFFFFFu;
+    }
+    if (size_t(end - p) < n) {
+        len = 1;
+        return 0xFFFFFFFFu;
+    }
+    for (size_t i = 1; i < n; i++) {
+        const uint8_t b = uint8_t(p[i]);
+        if ((b & 0xC0) != 0x80) {
+            len = 1;
+            return 0xFFFFFFFFu;
+        }
+        cp = (cp << 6) | (b & 0x3F);
+    }
+    // Отсекаем overlong-формы и суррогаты.
+    if ((n == 3 && cp < 0x800) || (n == 4 && (cp < 0x10000 || cp > 0x10FFFF)) ||
+        (cp >= 0xD800 && cp <= 0xDFFF)) {
+        len = 1;
+        return 0xFFFFFFFFu;
+    }
+    len = n;
+    return cp;
+}
+
+inline void append(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out.push_back(char(cp));
+    } else if (cp < 0x800) {
+        out.push_back(char(0xC0 | (cp >> 6)));
+        out.push_back(char(0x80 | (cp & 0x3F)));
+    } else if (cp < 0x10000) {
+        out.push_back(char(0xE0 | (cp >> 12)));
+        out.push_back(char(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(char(0x80 | (cp & 0x3F)));
+    } else {
+        out.push_back(char(0xF0 | (cp >> 18)));
+        out.push_back(char(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(char(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(char(0x80 | (cp & 0x3F)));
+    }
+}
+
+// Буквы и цифры вне ASCII: основные алфавиты, которые встречаются в логах.
+// Это не полная таблица Unicode (категории L* и Nd), а её практичное подмножество;
+// комбинируемые диакритики (U+0300..U+036F) считаются частью слова.
+struct Range {
+    uint32_t lo, hi;
+};
+
+static const Range kWordRanges[] = {
+    {0x00AA, 0x00AA}, {0x00B5, 0x00B5}, {0x00BA, 0x00BA}, {0x00C0, 0x00D6},
+    {0x00D8, 0x00F6}, {0x00F8, 0x02C1}, {0x0300, 0x036F}, {0x0370, 0x0374},
+    {0x0376, 0x0377}, {0x037B, 0x037D}, {0x037F, 0x037F}, {0x0386, 0x0386},
+    {0x0388, 0x038A}, {0x038C, 0x038C}, {0x038E, 0x03A1}, {0x03A3, 0x03F5},
+    {0x03F7, 0x0481}, {0x048A, 0x052F}, {0x0531, 0x0556}, {0x0561, 0x0587},
+    {0x05D0, 0x05EA}, {0x0620, 0x064A}, {0x0660, 0x0669}, {0x0671, 0x06D3},
+    {0x06F0, 0x06F9}, {0x0904, 0x0939}, {0x0966, 0x096F}, {0x0E01, 0x0E30},
+    {0x0E50, 0x0E59}, {0x10A0, 0x10FF}, {0x1100, 0x11FF}, {0x1E00, 0x1FBC},
+    {0x2C00, 0x2CE4}, {0x3041, 0x3096}, {0x30A1, 0x30FA}, {0x3400, 0x4DBF},
+    {0x4E00, 0x9FFF}, {0xAC00, 0xD7A3}, {0xFF10, 0xFF19}, {0xFF21, 0xFF3A},
+    {0xFF41, 0xFF5A}, {0x20000, 0x2A6DF},
+};
+
+// Для двухбайтовых символов (латиница, кириллица, греческий) —
+// битовая карта, чтобы не делать бинарный поиск на каждый символ.
+class WordBits {
+public:
+    WordBits() {
+        std::memset(bits_, 0, sizeof(bits_));
+        for (const Range& r : kWordRanges) {
+            for (uint32_t cp = r.lo; cp <= r.hi && cp < kLimit; cp++) bits_[cp >> 6] |= uint64_t(1) << (cp & 63);
+        }
+    }
+    bool test(uint32_t cp) const { return (bits_[cp >> 6] >> (cp & 63)) & 1; }
+
+    static constexpr uint32_t kLimit = 0x800;
+
+private:
+    uint64_t bits_[kLimit / 64];
+};
+
+inline bool is_word(uint32_t cp) {
+    static const WordBits bits;
+    if (cp < WordBits::kLimit) return bits.test(cp);
+    size_t lo = 0, hi = sizeof(kWordRanges) / sizeof(kWordRanges[0]);
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (cp > kWordRanges[mid].hi) lo = mid + 1;
+        else if (cp < kWordRanges[mid].lo) hi = mid;
+        else return true;
+    }
+    return false;
+}
+
+// Простое приведение регистра (simple case folding, CaseFolding.txt статусы C+S)
+// для латиницы, греческого, кириллицы, армянского и полноширинных форм.
+inline uint32_t fold(uint32_t cp) {
+    if (cp < 0x80) return (cp >= 'A' && cp <= 'Z') ? cp + 32 : cp;
+    if (cp < 0x100) {
+        if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) return cp + 32;
+        if (cp == 0xB5) return 0x3BC;
+        return cp;
+    }
+    if (cp < 0x180) {
+        if (cp == 0x130 || cp == 0x131 || cp == 0x138 || cp == 0x149) return cp;
+        if (cp == 0x178) return 0xFF;
+        if (cp == 0x17F) return 's';
+        if ((cp >= 0x139 && cp <= 0x148) || (cp >= 0x179 && cp <= 0x17E)) return (cp & 1) ? cp + 1 : cp;
+        return (cp & 1) ? cp : cp + 1;
+    }
+    if (cp >= 0x386 && cp <= 0x3AB) {
+        if (cp == 0x386) return 0x3AC;
+        if (cp >= 0x388 && cp <= 0x38A) return cp + 37;
+        if (cp == 0x38C) return 0x3CC;
+        if (cp == 0x38E || cp == 0x38F) return cp + 63;
+        if (cp >= 0x391 && cp != 0x3A2) return cp + 32;
+        return cp;
+    }
+    if (cp == 0x3C2) return 0x3C3;
+    if (cp >= 0x400 && cp <= 0x40F) return cp + 80;
+    if (cp >= 0x410 && cp <= 0x42F) return cp + 32;
+    if ((cp >= 0x460 && cp <= 0x481) || (cp >= 0x48A && cp <= 0x4BF) || (cp >= 0x4D0 && cp <= 0x52F)) {
+        return (cp & 1) ? cp : cp + 1;
+    }
+    if (cp == 0x4C0) return 0x4CF;
+    if (cp >= 0x4C1 && cp <= 0x4CE) return (cp & 1) ? cp + 1 : cp;
+    if (cp >= 0x531 && cp <= 0x556) return cp + 48;
+    if ((cp >= 0x1E00 && cp <= 0x1E95) || (cp >= 0x1EA0 && cp <= 0x1EFF)) return (cp & 1) ? cp : cp + 1;
+    if (cp >= 0xFF21 && cp <= 0xFF3A) return cp + 32;
+    return cp;
+}
+
+} // namespace utf8
+
+#endif // UTF8_HPP
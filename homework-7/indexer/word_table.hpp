@@ -0,0 +1,218 @@
+#ifndef WORD_TABLE_HPP
+#define WORD_TABLE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+// Хэш для коротких ключей: читаем по 8 байт и перемешиваем умножением.
+// Для слов из логов (в среднем 5-12 байт) это 1-2 итерации.
+inline uint64_t hash_word(std::string_view s) {
+    const uint64_t k = 0x9E3779B97F4A7C15ull;
+    const char* p = s.data();
+    size_t n = s.size();
+    uint64_t h = uint64_t(n) * k;
+    while (n >= 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        h = (h ^ v) * k;
+        h ^= h >> 29;
+        p += 8;
+        n -= 8;
+    }
+    if (n > 0) {
+        uint64_t v = 0;
+        std::memcpy(&v, p, n);
+        h = (h ^ v) * k;
+        h ^= h >> 29;
+    }
+    h *= k;
+    h ^= h >> 32;
+    return h;
+}
+
+// Арена для ключей: строки копируются в крупные блоки,
+// указатели на них стабильны до уничтожения арены.
+class Arena {
+public:
+    const char* store(std::string_view s) {
+        if (s.size() > left_) {
+            size_t sz = s.size() > kBlock ? s.size() : kBlock;
+            blocks_.emplace_back(new char[sz]);
+            cur_ = blocks_.back().get();
+            left_ = sz;
+        }
+        char* dst = cur_;
+        std::memcpy(dst, s.data(), s.size());
+        cur_ += s.size();
+        left_ -= s.size();
+        bytes_ += s.size();
+        return dst;
+    }
+
+    // Сколько байтов ключей скопировано в арену.
+    size_t bytes() const { return bytes_; }
+
+private:
+    static constexpr size_t kBlock = 1 << 20;
+
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* cur_ = nullptr;
+    size_t left_ = 0;
+    size_t bytes_ = 0;
+};
+
+// Плоская хэш-таблица с открытой адресацией (линейное пробирование).
+// Ключи живут в арене, ячейка таблицы — 24 байта без отдельных аллокаций.
+// Ключ может быть и "видом" (view) на чужую память — например, на отображённый
+// файл: тогда он не копируется, пока не будет вызван materialize().
+class WordTable {
+public:
+    explicit WordTable(size_t capacity_hint = 1024) {
+        size_t cap = 16;
+        while (cap < capacity_hint * 2) cap <<= 1;
+        slots_.resize(cap);
+        mask_ = cap - 1;
+    }
+
+    void add(std::string_view w, uint64_t n = 1) { insert(w, hash_word(w), n, false); }
+
+    void add_hashed(std::string_view w, uint64_t h, uint64_t n) { insert(w, h, n, false); }
+
+    // Новый ключ не копируется: память под w должна жить до materialize().
+    void add_view(std::string_view w, uint64_t n = 1) { insert(w, hash_word(w), n, true); }
+
+    // Копирует в арену все ключи-виды; после этого внешнюю память можно освобождать.
+    void materialize() {
+        if (views_ == 0) return;
+        for (Entry& e : slots_) {
+            if (e.key && (e.len & kViewBit)) {
+                e.len &= ~kViewBit;
+                e.key = arena_.store(std::string_view(e.key, e.len));
+            }
+        }
+        views_ = 0;
+    }
+
+    // Сколько байтов ключей скопировано в арену за всё время.
+    size_t copied_bytes() const { return arena_.bytes(); }
+
+    size_t size() const { return size_; }
+
+    template <class F>
+    void for_each(F&& f) const {
+        for (const Entry& e : slots_) {
+            if (e.key) f(std::string_view(e.key, e.len & ~kViewBit), e.count);
+        }
+    }
+
+private:
+    // Старший бит длины помечает ключ-вид (слова длиннее 2 ГиБ не бывают).
+    static constexpr uint32_t kViewBit = 0x80000000u;
+
+    void insert(std::string_view w, uint64_t h, uint64_t n, bool view) {
+        const uint32_t tag = uint32_t(h >> 32);
+        size_t i = size_t(h) & mask_;
+        for (;;) {
+            Entry& e = slots_[i];
+            if (!e.key) {
+                if (view) {
+                    e.key = w.data();
+                    e.len = uint32_t(w.size()) | kViewBit;
+                    views_++;
+                } else {
+                    e.key = arena_.store(w);
+                    e.len = uint32_t(w.size());
+                }
+                e.tag = tag;
+                e.count = n;
+                if (++size_ * 10 > slots_.size() * 7) grow();
+                return;
+            }
+            if (e.tag == tag && (e.len & ~kViewBit) == w.size() && std::memcmp(e.key, w.data(), w.size()) == 0) {
+                e.count += n;
+                return;
+            }
+            i = (i + 1) & mask_;
+        }
+    }
+
+    struct Entry {
+        const char* key = nullptr;
+        uint32_t len = 0;
+        uint32_t tag = 0;
+        uint64_t count = 0;
+    };
+
+    void grow() {
+        std::vector<Entry> old(slots_.size() * 2);
+        old.swap(slots_);
+        mask_ = slots_.size() - 1;
+        for (const Entry& e : old) {
+            if (!e.key) continue;
+            size_t i = size_t(hash_word(std::string_view(e.key, e.len & ~kViewBit))) & mask_;
+            while (slots_[i].key) i = (i + 1) & mask_;
+            slots_[i] = e;
+        }
+    }
+
+    std::vector<Entry> slots_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+    size_t views_ = 0;
+    Arena arena_;
+};
+
+// Глобальный индекс: несколько сегментов со своими mutex.
+// Локальная таблица потока вливается целиком, каждый сегмент блокируется один раз.
+class ShardedTable {
+public:
+    explicit ShardedTable(size_t shard_bits = 6) : bits_(shard_bits) {
+        for (size_t i = 0; i < (size_t(1) << bits_); i++) shards_.emplace_back(new Shard);
+    }
+
+    void merge(const WordTable& local) {
+        struct Item {
+            std::string_view word;
+            uint64_t hash;
+            uint64_t count;
+        };
+        std::vector<std::vector<Item>> parts(shards_.size());
+        local.for_each([&](std::string_view w, uint64_t c) {
+            uint64_t h = hash_word(w);
+            parts[h >> (64 - bits_)].push_back(Item{w, h, c});
+        });
+        for (size_t s = 0; s < shards_.size(); s++) {
+            if (parts[s].empty()) continue;
+            std::lock_guard<std::mutex> lock(shards_[s]->mu);
+            for (const Item& it : parts[s]) shards_[s]->table.add_hashed(it.word, it.hash, it.count);
+        }
+    }
+
+    // Вызывать только после завершения всех потоков.
+    template <class F>
+    void for_each(F&& f) const {
+        for (const auto& s : shards_) s->table.for_each(f);
+    }
+
+    size_t size() const {
+        size_t n = 0;
+        for (const auto& s : shards_) n += s->table.size();
+        return n;
+    }
+
+private:
+    struct Shard {
+        std::mutex mu;
+        WordTable table;
+    };
+
+    size_t bits_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+#endif // WORD_TABLE_HPP